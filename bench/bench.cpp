@@ -0,0 +1,225 @@
+#include "bench.h"
+#include "core/replay_store.h"
+#include "util/alloc_hook.h"
+#include "util/config.h"
+#include "util/format.h"
+
+#include <argparse/argparse.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <random>
+
+namespace bench {
+
+TimeSeriesRes synthetic(size_t n, uint64_t seed) {
+  std::mt19937_64 gen{seed};
+  std::normal_distribution<double> ret{0.0002, 0.006};
+  std::uniform_real_distribution<double> wick{0.0, 0.004};
+  std::uniform_int_distribution<int> vol{100'000, 2'000'000};
+
+  TimeSeriesRes res;
+  res.reserve(n);
+
+  // a monday, 7 hourly candles from 9:30 on every weekday
+  auto day = LocalTimePoint{std::chrono::local_days{
+      std::chrono::year{2020} / 1 / 6}};
+  double price = 100.0;
+
+  while (res.size() < n) {
+    std::chrono::weekday wd{std::chrono::floor<days>(day)};
+    if (wd != std::chrono::Saturday && wd != std::chrono::Sunday) {
+      for (int h = 0; h < 7 && res.size() < n; h++) {
+        auto open = price;
+        auto close = open * std::exp(ret(gen));
+        res.push_back({
+            .datetime = day + hours{9} + minutes{30} + hours{h},
+            .open = open,
+            .high = std::max(open, close) * (1 + wick(gen)),
+            .low = std::min(open, close) * (1 - wick(gen)),
+            .close = close,
+            .volume = vol(gen),
+        });
+        price = close;
+      }
+    }
+    day += days{1};
+  }
+
+  return res;
+}
+
+TimeSeriesRes recorded(const std::string& symbol, size_t n) {
+  ReplayStore store{replay_fname};
+  auto v = store.find(symbol);
+  if (v == nullptr)
+    return {};
+  auto from = v->size() > n ? v->size() - n : 0;
+  return v->slice(from, v->size());
+}
+
+TimeSeriesRes daily(const TimeSeriesRes& hourly) {
+  TimeSeriesRes res;
+  for (auto& c : hourly) {
+    auto day = LocalTimePoint{std::chrono::floor<days>(c.time())};
+    if (res.empty() || res.back().time() != day) {
+      res.push_back(c);
+      res.back().datetime = day;
+      continue;
+    }
+    auto& d = res.back();
+    d.high = std::max(d.high, c.high);
+    d.low = std::min(d.low, c.low);
+    d.close = c.close;
+    d.volume += c.volume;
+  }
+  return res;
+}
+
+Result measure(const Kernel& k, double min_time_s) {
+  using namespace std::chrono;
+
+  k.run();  // warm up
+
+  Result r{.name = k.name};
+  auto allocs = thread_allocs();
+  auto start = steady_clock::now();
+  auto elapsed = [&] { return duration<double>(steady_clock::now() - start); };
+
+  while (r.ops < 3 || elapsed().count() < min_time_s) {
+    k.run();
+    r.ops++;
+  }
+
+  auto s = elapsed().count();
+  r.ns_per_op = s * 1e9 / r.ops;
+  r.allocs_per_op = double(thread_allocs() - allocs) / r.ops;
+  r.items_per_s = s > 0 ? k.items * r.ops / s : 0.0;
+  return r;
+}
+
+}  // namespace bench
+
+int main(int argc, char* argv[]) {
+  argparse::ArgumentParser program("fin_bench");
+
+  program.add_argument("-n", "--candles")
+      .help("Candles per series")
+      .default_value(size_t{3000})
+      .scan<'d', size_t>();
+
+  program.add_argument("--min-time")
+      .help("Seconds each kernel runs for at least")
+      .default_value(0.5)
+      .scan<'g', double>();
+
+  program.add_argument("-f", "--filter")
+      .help("Only run kernels whose name contains this")
+      .default_value(std::string{});
+
+  program.add_argument("--recorded")
+      .help("Use this symbol's candles from the replay data")
+      .default_value(std::string{});
+
+  program.add_argument("--macro")
+      .help("Run the end-to-end startup and update cycle benchmark")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--http")
+      .help("Check the multiplexed http path against a loopback server")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--tickers")
+      .help("Tickers in the macro benchmark")
+      .default_value(size_t{50})
+      .scan<'d', size_t>();
+
+  program.add_argument("--cycles")
+      .help("Update cycles in the macro benchmark")
+      .default_value(size_t{50})
+      .scan<'d', size_t>();
+
+  program.add_argument("-j", "--threads")
+      .help("Threads of the macro benchmark")
+      .default_value(size_t{1})
+      .scan<'d', size_t>();
+
+  program.add_argument("--baseline")
+      .help("Compare the macro benchmark against this baseline json")
+      .default_value(std::string{});
+
+  program.add_argument("--save-baseline")
+      .help("Write the macro benchmark result to this json")
+      .default_value(std::string{});
+
+  program.add_argument("--tolerance")
+      .help("Allowed slowdown against the baseline, as a fraction")
+      .default_value(0.25)
+      .scan<'g', double>();
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << "\n" << program << "\n";
+    return 1;
+  }
+
+  bench::Options opts{
+      .n_candles = program.get<size_t>("--candles"),
+      .min_time_s = program.get<double>("--min-time"),
+      .filter = program.get<std::string>("--filter"),
+      .recorded = program.get<std::string>("--recorded"),
+  };
+
+  spdlog::set_level(spdlog::level::warn);
+
+  if (program.get<bool>("--http"))
+    return bench::check_http();
+
+  if (program.get<bool>("--macro"))
+    return bench::macro({
+        .n_tickers = program.get<size_t>("--tickers"),
+        .n_candles = opts.n_candles,
+        .n_cycles = program.get<size_t>("--cycles"),
+        .n_threads = std::max<size_t>(program.get<size_t>("--threads"), 1),
+        .baseline = program.get<std::string>("--baseline"),
+        .save_baseline = program.get<std::string>("--save-baseline"),
+        .tolerance = program.get<double>("--tolerance"),
+    });
+
+  auto candles = opts.recorded.empty()
+                     ? bench::synthetic(opts.n_candles)
+                     : bench::recorded(opts.recorded, opts.n_candles);
+  if (candles.size() < 200) {
+    std::cerr << "[bench] not enough candles" << std::endl;
+    return 1;
+  }
+
+  if (auto failed = bench::check_roundtrip(candles); !failed.empty()) {
+    std::cerr << std::format("[bench] pop_back/push_back drifts: {}\n",
+                             join(failed.begin(), failed.end()));
+    return 1;
+  }
+
+  std::cout << std::format("{} candles ({})\n", candles.size(),
+                           opts.recorded.empty() ? "synthetic" : opts.recorded);
+  std::cout << std::format("{:<24} {:>10} {:>14} {:>12} {:>14}\n", "kernel",
+                           "ops", "ns/op", "allocs/op", "candles/s");
+
+  for (auto& k : bench::kernels(candles)) {
+    if (!opts.filter.empty() && k.name.find(opts.filter) == std::string::npos)
+      continue;
+    auto r = bench::measure(k, opts.min_time_s);
+    std::cout << std::format("{:<24} {:>10} {:>14.0f} {:>12.1f} {:>14.0f}\n",
+                             r.name, r.ops, r.ns_per_op, r.allocs_per_op,
+                             r.items_per_s);
+  }
+
+  return 0;
+}
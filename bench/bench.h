@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ind/candle.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Options {
+  size_t n_candles = 3000;
+  double min_time_s = 0.5;
+  std::string filter;    // only kernels whose name contains this
+  std::string recorded;  // symbol from the replay data, synthetic if empty
+};
+
+struct MacroOptions {
+  size_t n_tickers = 50;
+  size_t n_candles = 3000;  // history each ticker starts with
+  size_t n_cycles = 50;
+  size_t n_threads = 1;
+
+  std::string baseline;       // compared against, if set
+  std::string save_baseline;  // written to, if set
+  double tolerance = 0.25;    // allowed slowdown of a timing
+};
+
+// Startup of N tickers and K update cycles through the same Metrics,
+// CombinedSignal and Risk work a Portfolio does, on synthetic data. Returns
+// the exit code: non-zero if a baseline was given and this run regressed.
+int macro(const MacroOptions& opts);
+
+// http::get_all and post_async against a loopback server: responses in
+// request order and no more in flight than asked. Returns the exit code.
+int check_http();
+
+// One kernel. `run` does one op over `items` candles; setup work that isn't
+// measured happens before it's registered.
+struct Kernel {
+  std::string name;
+  size_t items = 1;
+  std::function<void()> run;
+};
+
+struct Result {
+  std::string name;
+  size_t ops = 0;
+  double ns_per_op = 0.0;
+  double allocs_per_op = 0.0;
+  double items_per_s = 0.0;
+};
+
+// deterministic hourly candles over market hours, a seeded random walk
+TimeSeriesRes synthetic(size_t n, uint64_t seed = 42);
+
+// the last n candles of `symbol` in the replay data
+TimeSeriesRes recorded(const std::string& symbol, size_t n);
+
+// daily candles out of hourly ones
+TimeSeriesRes daily(const TimeSeriesRes& hourly);
+
+std::vector<Kernel> kernels(const TimeSeriesRes& candles);
+
+// the push_back kernels pop and push again, which only measures the live
+// path if a pop_back then push_back of the same candle gives back the
+// values the constructor did. names of the indicators that don't
+std::vector<std::string> check_roundtrip(const TimeSeriesRes& candles);
+
+Result measure(const Kernel& k, double min_time_s);
+
+// keeps the optimizer from dropping a result
+template <typename T>
+inline void keep(T&& t) {
+  asm volatile("" : : "g"(&t) : "memory");
+}
+
+}  // namespace bench
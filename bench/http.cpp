@@ -0,0 +1,158 @@
+#include "bench.h"
+#include "mt/http.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+// Answers every request with its path after a short delay, one connection
+// per request, and counts how many were open at once.
+class LoopbackServer {
+  int fd = -1;
+  uint16_t port = 0;
+
+  std::atomic<bool> stopping = false;
+  std::atomic<int> in_flight = 0;
+  std::atomic<int> peak = 0;
+
+  std::mutex mtx;
+  std::vector<std::thread> conns;
+  std::thread acceptor;
+
+  void serve(int c) {
+    auto n = ++in_flight;
+    for (auto p = peak.load(); n > p && !peak.compare_exchange_weak(p, n);)
+      ;
+
+    std::string req;
+    char buf[4096];
+    while (req.find("\r\n\r\n") == std::string::npos) {
+      auto r = ::recv(c, buf, sizeof(buf), 0);
+      if (r <= 0)
+        break;
+      req.append(buf, r);
+    }
+
+    // the body of a post is read so the client sees the response
+    auto head_end = req.find("\r\n\r\n");
+    auto cl = req.find("Content-Length: ");
+    if (head_end != std::string::npos && cl != std::string::npos) {
+      auto want = head_end + 4 + std::stoul(req.substr(cl + 16));
+      while (req.size() < want) {
+        auto r = ::recv(c, buf, sizeof(buf), 0);
+        if (r <= 0)
+          break;
+        req.append(buf, r);
+      }
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    auto path_start = req.find(' ') + 1;
+    auto path = req.substr(path_start, req.find(' ', path_start) - path_start);
+    path = path.substr(0, path.find('?'));
+    auto res = std::format(
+        "HTTP/1.1 200 OK\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}",
+        path.size(), path);
+
+    in_flight--;
+    ::send(c, res.data(), res.size(), MSG_NOSIGNAL);
+    ::close(c);
+  }
+
+ public:
+  LoopbackServer() {
+    fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (fd == -1 || ::bind(fd, (sockaddr*)&addr, len) == -1 ||
+        ::listen(fd, 64) == -1 || ::getsockname(fd, (sockaddr*)&addr, &len)) {
+      return;
+    }
+    port = ntohs(addr.sin_port);
+
+    acceptor = std::thread{[this] {
+      while (!stopping) {
+        int c = ::accept(fd, nullptr, nullptr);
+        if (c == -1)
+          continue;
+        std::lock_guard _{mtx};
+        conns.emplace_back([this, c] { serve(c); });
+      }
+    }};
+  }
+
+  ~LoopbackServer() {
+    stopping = true;
+    ::shutdown(fd, SHUT_RDWR);
+    if (acceptor.joinable())
+      acceptor.join();
+    for (auto& t : conns)
+      t.join();
+    ::close(fd);
+  }
+
+  bool ok() const { return port != 0; }
+  std::string url() const { return std::format("http://127.0.0.1:{}", port); }
+  int max_in_flight() const { return peak; }
+};
+
+int check_http() {
+  constexpr size_t N = 24, WINDOW = 4;
+
+  LoopbackServer server;
+  if (!server.ok()) {
+    std::cerr << "[http] can't listen on the loopback\n";
+    return 1;
+  }
+
+  std::vector<http::Request> reqs;
+  for (size_t i = 0; i < N; i++)
+    reqs.push_back(http::Request{.url = std::format("{}/{}", server.url(), i),
+                                 .params = {{"k", std::to_string(i)}}});
+
+  int failed = 0;
+  auto fail = [&](std::string msg) {
+    std::cerr << "[http] " << msg << "\n";
+    failed++;
+  };
+
+  auto res = http::get_all(reqs, WINDOW);
+  if (res.size() != N)
+    fail(std::format("{} responses to {} requests", res.size(), N));
+  for (size_t i = 0; i < res.size(); i++) {
+    auto want = std::format("/{}", i);
+    if (res[i].status_code != 200 || res[i].text != want)
+      fail(std::format("response {} is {} '{}'", i, res[i].status_code,
+                       res[i].text));
+  }
+
+  auto peak = server.max_in_flight();
+  if (peak > static_cast<int>(WINDOW))
+    fail(std::format("{} requests in flight, at most {} asked", peak, WINDOW));
+
+  auto post = http::post_async(server.url() + "/post", {{"k", "v"}}).get();
+  if (post.status_code != 200 || post.text != "/post")
+    fail(std::format("post is {} '{}'", post.status_code, post.text));
+
+  std::cout << std::format("[http] {} gets, {} at most in flight, post {}\n",
+                           res.size(), peak, post.status_code);
+  return failed == 0 ? 0 : 1;
+}
+
+}  // namespace bench
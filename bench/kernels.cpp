@@ -0,0 +1,126 @@
+#include "bench.h"
+#include "core/positions.h"
+#include "ind/calendar.h"
+#include "ind/indicators.h"
+#include "risk/risk.h"
+#include "sig/combined_signal.h"
+
+#include <memory>
+
+namespace bench {
+
+// the layers of Indicators are only constructible from a subclass
+struct CoreFixture : IndicatorsCore {
+  CoreFixture(TimeSeriesRes c) : IndicatorsCore{std::move(c), H_1} {}
+};
+
+struct TrendsFixture : IndicatorsTrends {
+  TrendsFixture(TimeSeriesRes c) : IndicatorsTrends{std::move(c), H_1} {}
+};
+
+struct Fixtures {
+  TimeSeriesRes candles;
+  Candle next;
+
+  CoreFixture core;
+  TrendsFixture trends;
+  Indicators ind;
+  Indicators spy;
+  Metrics metrics;
+  OpenPositions positions;
+  CombinedSignal signal;
+
+  Fixtures(const TimeSeriesRes& c)
+      : candles{c.begin(), c.end() - 1},
+        next{c.back()},
+        core{candles},
+        trends{candles},
+        ind{TimeSeriesRes{candles}, H_1},
+        spy{daily(candles), D_1},
+        metrics{TimeSeriesRes{candles}, H_1, nullptr},
+        positions{Trades{}},
+        signal{metrics, Event{}} {}
+};
+
+std::vector<Kernel> kernels(const TimeSeriesRes& candles) {
+  auto f = std::make_shared<Fixtures>(candles);
+  auto n = f->candles.size();
+  auto& cs = f->candles;
+
+  auto ema = std::make_shared<EMA>(cs, 21);
+  auto rsi = std::make_shared<RSI>(cs);
+  auto macd = std::make_shared<MACD>(cs);
+  auto atr = std::make_shared<ATR>(cs);
+
+  // push_back kernels pop again, so every op sees the same series
+  return {
+      {"ema/ctor", n, [f] { keep(EMA{f->candles, 21}); }},
+      {"ema/push_back", 1,
+       [ema, f] {
+         ema->push_back(f->next);
+         ema->pop_back();
+       }},
+      {"rsi/ctor", n, [f] { keep(RSI{f->candles}); }},
+      {"rsi/push_back", 1,
+       [rsi, f] {
+         rsi->push_back(f->next);
+         rsi->pop_back();
+       }},
+      {"macd/ctor", n, [f] { keep(MACD{f->candles}); }},
+      {"macd/push_back", 1,
+       [macd, f] {
+         macd->push_back(f->next);
+         macd->pop_back();
+       }},
+      {"atr/ctor", n, [f] { keep(ATR{f->candles}); }},
+      {"atr/push_back", 1,
+       [atr, f] {
+         atr->push_back(f->next);
+         atr->pop_back(f->candles.back().close);
+       }},
+      {"trendlines", n, [f] { keep(Trends{f->core}); }},
+      {"sr/support", n, [f] { keep(Support{f->core}); }},
+      {"sr/resistance", n, [f] { keep(Resistance{f->core}); }},
+      {"backtest+stats", n, [f] { keep(Stats{f->trends}); }},
+      {"indicators/ctor", n,
+       [f] { keep(Indicators{TimeSeriesRes{f->candles}, H_1}); }},
+      {"indicators/push_back", 1,
+       [f] {
+         f->ind.push_back(f->next);
+         f->ind.pop_back();
+       }},
+      {"signal", 1, [f] { keep(Signal{f->ind}); }},
+      {"combined_signal", 1,
+       [f] { keep(CombinedSignal{f->metrics, Event{}}); }},
+      {"risk", 1,
+       [f] {
+         keep(Risk{f->metrics, f->spy, {}, f->signal, f->positions, Event{}});
+       }},
+  };
+}
+
+std::vector<std::string> check_roundtrip(const TimeSeriesRes& candles) {
+  std::vector<std::string> res;
+  auto& last = candles.back();
+
+  auto check = [&](auto name, auto ind, auto& values, auto... pop_args) {
+    auto want = values.back();
+    ind->pop_back(pop_args...);
+    ind->push_back(last);
+    if (values.back() != want)
+      res.push_back(name);
+  };
+
+  auto rsi = std::make_shared<RSI>(candles);
+  check("rsi", rsi, rsi->values);
+  auto ema = std::make_shared<EMA>(candles, 21);
+  check("ema", ema, ema->values);
+  auto macd = std::make_shared<MACD>(candles);
+  check("macd", macd, macd->histogram);
+  auto atr = std::make_shared<ATR>(candles);
+  check("atr", atr, atr->values, candles[candles.size() - 2].close);
+
+  return res;
+}
+
+}  // namespace bench
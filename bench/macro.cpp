@@ -0,0 +1,262 @@
+#include "bench.h"
+#include "core/positions.h"
+#include "core/replay_stats.h"
+#include "ind/calendar.h"
+#include "ind/indicators.h"
+#include "mt/thread_pool.h"
+#include "risk/risk.h"
+#include "sig/combined_signal.h"
+#include "util/alloc_hook.h"
+#include "util/arena.h"
+
+#include <glaze/glaze.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <numeric>
+#include <optional>
+
+namespace bench {
+
+// One run, also the layout of the baseline file. Stage times are summed over
+// the threads that ran them, cycles are wall times.
+struct MacroResult {
+  size_t n_tickers = 0;
+  size_t n_candles = 0;
+  size_t n_cycles = 0;
+  size_t n_threads = 0;  // stage sums and cycle times both depend on it
+
+  double startup_ms = 0.0;
+  double push_ms = 0.0;
+  double signal_ms = 0.0;
+  double risk_ms = 0.0;
+  double cycle_p50_ms = 0.0;
+  double cycle_p99_ms = 0.0;
+
+  double peak_rss_mb = 0.0;
+  uint64_t startup_allocs = 0;
+  uint64_t cycle_allocs = 0;
+};
+
+// allocation counts only move when the code does, give or take the library
+inline constexpr double alloc_tolerance = 0.02;
+
+inline double ms_since(std::chrono::steady_clock::time_point start) {
+  using namespace std::chrono;
+  return duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
+// Ticker::calc_signal split into its stages, without the ticker around it
+struct MacroTicker {
+  Metrics metrics;
+  CombinedSignal signal;
+  Risk risk;
+};
+
+inline MacroResult run_macro(const MacroOptions& opts) {
+  using namespace std::chrono;
+
+  MacroResult res{
+      .n_tickers = opts.n_tickers,
+      .n_candles = opts.n_candles,
+      .n_cycles = opts.n_cycles,
+      .n_threads = opts.n_threads,
+  };
+
+  // every ticker is its own walk, spy is a daily one that stays put
+  std::vector<TimeSeriesRes> series(opts.n_tickers);
+  for (size_t i = 0; i < opts.n_tickers; i++)
+    series[i] = synthetic(opts.n_candles + opts.n_cycles, 1000 + i);
+
+  Indicators spy{daily(synthetic(opts.n_candles, 42)), D_1};
+  OpenPositions positions{Trades{}};
+  Event ev;
+
+  std::vector<size_t> ids(opts.n_tickers);
+  std::iota(ids.begin(), ids.end(), 0);
+
+  std::atomic<int64_t> push_ns = 0, signal_ns = 0, risk_ns = 0;
+  std::atomic<uint64_t> startup_allocs = 0, cycle_allocs = 0;
+  auto add = [](std::atomic<int64_t>& ns, steady_clock::time_point start) {
+    ns += duration_cast<nanoseconds>(steady_clock::now() - start).count();
+  };
+
+  std::vector<std::optional<MacroTicker>> tickers(opts.n_tickers);
+
+  auto start = steady_clock::now();
+  {
+    auto func = [&](size_t&& i) {
+      auto allocs = thread_allocs();
+      auto& s = series[i];
+      Metrics metrics{TimeSeriesRes{s.begin(), s.begin() + opts.n_candles},
+                      H_1, nullptr};
+      CombinedSignal signal{metrics, ev};
+      Risk risk{metrics, spy, LocalTimePoint{}, signal, positions, ev};
+      signal.apply_stop_hit(risk.get_stop_hit(metrics));
+      tickers[i].emplace(std::move(metrics), std::move(signal),
+                         std::move(risk));
+      startup_allocs += thread_allocs() - allocs;
+      return true;
+    };
+    thread_pool<size_t> pool{opts.n_threads, func, ids};
+  }
+  res.startup_ms = ms_since(start);
+  res.startup_allocs = startup_allocs.load();
+
+  std::vector<double> cycle_ms;
+  cycle_ms.reserve(opts.n_cycles);
+
+  for (size_t k = 0; k < opts.n_cycles; k++) {
+    auto func = [&](size_t&& i) {
+      auto allocs = thread_allocs();
+      auto& t = *tickers[i];
+
+      // as in Ticker::push_back
+      ScratchScope _;
+      auto t0 = steady_clock::now();
+      t.metrics.push_back(series[i][opts.n_candles + k], nullptr);
+      add(push_ns, t0);
+
+      auto t1 = steady_clock::now();
+      t.signal = CombinedSignal{t.metrics, ev};
+      add(signal_ns, t1);
+
+      auto t2 = steady_clock::now();
+      t.risk = Risk{t.metrics, spy, LocalTimePoint{}, t.signal, positions, ev};
+      t.signal.apply_stop_hit(t.risk.get_stop_hit(t.metrics));
+      add(risk_ns, t2);
+      cycle_allocs += thread_allocs() - allocs;
+      return true;
+    };
+
+    auto cycle_start = steady_clock::now();
+    {
+      thread_pool<size_t> pool{opts.n_threads, func, ids};
+    }
+    cycle_ms.push_back(ms_since(cycle_start));
+  }
+  res.cycle_allocs = cycle_allocs.load();
+
+  res.push_ms = push_ns.load() / 1e6;
+  res.signal_ms = signal_ns.load() / 1e6;
+  res.risk_ms = risk_ns.load() / 1e6;
+
+  if (!cycle_ms.empty()) {
+    std::sort(cycle_ms.begin(), cycle_ms.end());
+    auto at = [&](double q) {
+      return cycle_ms[static_cast<size_t>(q * (cycle_ms.size() - 1))];
+    };
+    res.cycle_p50_ms = at(0.5);
+    res.cycle_p99_ms = at(0.99);
+  }
+
+  res.peak_rss_mb = peak_rss_mb();
+  return res;
+}
+
+inline void print_row(const std::string& name,
+                      double now,
+                      std::optional<double> base,
+                      bool regressed) {
+  if (!base) {
+    std::cout << std::format("{:<16} {:>14.2f}\n", name, now);
+    return;
+  }
+  auto pct = *base > 0 ? 100 * (now - *base) / *base : 0.0;
+  std::cout << std::format("{:<16} {:>14.2f} {:>14.2f} {:>+8.1f}%{}\n", name,
+                           now, *base, pct, regressed ? "  REGRESSED" : "");
+}
+
+// number of metrics over their tolerance, all of them printed
+inline size_t compare(const MacroResult& now,
+                      const std::optional<MacroResult>& base,
+                      double tolerance) {
+  size_t n_regressed = 0;
+  auto row = [&](const std::string& name, double MacroResult::*field,
+                 double tol) {
+    std::optional<double> b;
+    bool regressed = false;
+    if (base) {
+      b = (*base).*field;
+      regressed = now.*field > *b * (1 + tol);
+    }
+    n_regressed += regressed;
+    print_row(name, now.*field, b, regressed);
+  };
+  auto count_row = [&](const std::string& name, uint64_t MacroResult::*field) {
+    std::optional<double> b;
+    bool regressed = false;
+    if (base) {
+      b = static_cast<double>((*base).*field);
+      regressed = now.*field > *b * (1 + alloc_tolerance);
+    }
+    n_regressed += regressed;
+    print_row(name, static_cast<double>(now.*field), b, regressed);
+  };
+
+  if (base)
+    std::cout << std::format("{:<16} {:>14} {:>14} {:>9}\n", "metric", "now",
+                             "baseline", "change");
+  else
+    std::cout << std::format("{:<16} {:>14}\n", "metric", "now");
+
+  row("startup ms", &MacroResult::startup_ms, tolerance);
+  row("push ms", &MacroResult::push_ms, tolerance);
+  row("signal ms", &MacroResult::signal_ms, tolerance);
+  row("risk ms", &MacroResult::risk_ms, tolerance);
+  row("cycle p50 ms", &MacroResult::cycle_p50_ms, tolerance);
+  row("cycle p99 ms", &MacroResult::cycle_p99_ms, tolerance);
+  row("peak rss MB", &MacroResult::peak_rss_mb, tolerance);
+  count_row("startup allocs", &MacroResult::startup_allocs);
+  count_row("cycle allocs", &MacroResult::cycle_allocs);
+  return n_regressed;
+}
+
+int macro(const MacroOptions& opts) {
+  std::optional<MacroResult> base;
+  if (!opts.baseline.empty()) {
+    MacroResult b;
+    auto ec = glz::read_file_json(b, opts.baseline, std::string{});
+    if (ec) {
+      std::cerr << std::format("[bench] error reading {}: {}\n", opts.baseline,
+                               glz::format_error(ec));
+      return 1;
+    }
+    if (b.n_tickers != opts.n_tickers || b.n_candles != opts.n_candles ||
+        b.n_cycles != opts.n_cycles || b.n_threads != opts.n_threads) {
+      std::cerr << std::format(
+          "[bench] {} is for {} tickers, {} candles, {} cycles, {} threads\n",
+          opts.baseline, b.n_tickers, b.n_candles, b.n_cycles, b.n_threads);
+      return 1;
+    }
+    base = b;
+  }
+
+  std::cout << std::format("{} tickers, {} candles, {} cycles, {} threads\n",
+                           opts.n_tickers, opts.n_candles, opts.n_cycles,
+                           opts.n_threads);
+
+  auto res = run_macro(opts);
+  auto n_regressed = compare(res, base, opts.tolerance);
+
+  if (!opts.save_baseline.empty()) {
+    constexpr auto glz_opts = glz::opts{.prettify = true};
+    auto ec = glz::write_file_json<glz_opts>(res, opts.save_baseline,
+                                             std::string{});
+    if (ec) {
+      std::cerr << std::format("[bench] error writing {}\n",
+                               opts.save_baseline);
+      return 1;
+    }
+  }
+
+  if (n_regressed > 0) {
+    std::cout << std::format("{} metrics regressed\n", n_regressed);
+    return 2;
+  }
+  return 0;
+}
+
+}  // namespace bench
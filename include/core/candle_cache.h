@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ind/candle.h"
+#include "util/times.h"
+
+#include <cstdint>
+#include <string>
+
+// Candles of one symbol and timeframe on disk, at
+// private/candles/{symbol}_{minutes}m.bin: a header followed by fixed size
+// records, oldest first. Reads map the file, updates only touch the tail.
+// The file is compacted to what time_series reads back once it holds twice
+// that.
+class CandleCache {
+  struct Header {
+    char magic[4] = {'F', 'C', 'N', 'D'};
+    uint32_t version = 1;
+  };
+
+  struct Record {
+    int64_t time;  // seconds of the local ny time
+    double open;
+    double high;
+    double low;
+    double close;
+    int64_t volume;
+  };
+
+  const std::string path;
+  const minutes timeframe;
+
+  static Record to_record(const Candle& c);
+  static Candle to_candle(const Record& r);
+
+  bool compact() const;
+
+ public:
+  CandleCache(const std::string& symbol, minutes timeframe) noexcept;
+
+  // the last `max_n` candles
+  TimeSeriesRes read(size_t max_n = SIZE_MAX) const;
+
+  bool write(const TimeSeriesRes& candles) const;
+
+  // replaces the stored candles from fresh.front() on
+  bool merge(const TimeSeriesRes& fresh) const;
+
+  // appends the candle, or overwrites the last one if it has the same time.
+  // if candles are missing before it, the file is dropped so the next
+  // time_series fetches the whole series again
+  bool put(const Candle& candle) const;
+};
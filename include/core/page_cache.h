@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Page fragments rendered from one ticker, each kept with the stamp of the
+// state it was rendered from (the ticker version, mixed with whatever else
+// it reads). A page only renders the fragments whose stamp moved.
+class FragmentCache {
+  struct Fragment {
+    uint64_t stamp = 0;
+    bool valid = false;
+    std::string html;
+  };
+
+  std::mutex mtx;
+  std::map<std::string, Fragment, std::less<>> fragments;
+
+  static void count(bool rendered);
+
+ public:
+  // the fragment of `key` at `stamp`, rendered by `render` on a miss
+  template <typename F>
+  std::string get(const std::string& key, uint64_t stamp, F&& render) {
+    std::lock_guard _{mtx};
+    auto& f = fragments[key];
+    bool miss = !f.valid || f.stamp != stamp;
+    if (miss) {
+      f.html = render();
+      f.stamp = stamp;
+      f.valid = true;
+    }
+    count(miss);
+    return f.html;
+  }
+
+  // true if `key` wasn't stored at `stamp`, for fragments that are whole
+  // files and are stored only once written
+  bool stale(const std::string& key, uint64_t stamp) {
+    std::lock_guard _{mtx};
+    auto it = fragments.find(key);
+    bool miss = it == fragments.end() || !it->second.valid ||
+                it->second.stamp != stamp;
+    count(miss);
+    return miss;
+  }
+
+  void store(const std::string& key, uint64_t stamp) {
+    std::lock_guard _{mtx};
+    auto& f = fragments[key];
+    f.stamp = stamp;
+    f.valid = true;
+  }
+};
+
+inline uint64_t mix(uint64_t h, uint64_t v) {
+  return h ^ (v + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2));
+}
+
+// Writes `content` to `path` unless the last successful write there had the
+// same content hash. False only if the write failed.
+bool write_if_changed(const std::string& path, const std::string& content);
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "page_cache.h"
 #include "positions.h"
 #include "replay.h"
+#include "replay_stats.h"
+#include "schedule.h"
 
 #include "ind/ticker.h"
 #include "mt/api.h"
@@ -9,32 +12,64 @@
 #include "util/config.h"
 #include "util/symbols.h"
 #include "util/times.h"
+#include "util/undo_log.h"
 
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 using Tickers = std::map<std::string, Ticker>;
 enum class FormatTarget;
 
+struct StopLevels {
+  double stop = 0.0;
+  double target = 0.0;
+};
+
 class Portfolio : public Endpoint {
  private:
   Symbols symbols;
 
   mutable std::shared_mutex mtx;
   std::thread server;
+  std::thread monitor;
 
   TD td;
   Replay rp;
 
   Indicators spy;
+  UndoLog<Indicators::Undo> spy_undo;  // replay only
   Tickers tickers;
   OpenPositions positions;
   Calendar calendar;
 
-  const minutes update_interval;
+  RefreshPlan plan;
+  minutes update_interval;
+  std::atomic<seconds> monitor_interval{seconds{0}};  // from the plan
+
+  // stop and target of each ticker as of its last recompute. compute_f
+  // rewrites the Risk without the writer lock, so the monitor reads these
+  mutable std::mutex levels_mtx;
+  std::unordered_map<std::string, StopLevels> levels;
+  ReplayStats stats;
   std::string tunnel_url;
 
+  // what the pages last rendered from each ticker
+  mutable FragmentCache index_rows;
+  mutable FragmentCache position_rows;
+  mutable FragmentCache ticker_pages;
+  mutable std::atomic<uint64_t> history_stamp = 0;
+
+  // pages render off the calling thread; await_pages joins every writer
+  // started so far
+  mutable std::mutex pages_mtx;
+  mutable std::vector<std::thread> page_writers;
+
  public:
   LocalTimePoint last_updated;
 
@@ -55,6 +90,8 @@ class Portfolio : public Endpoint {
                             : td.real_time(std::forward<Args>(args)...);
   }
 
+  RefreshPlan plan_refresh() const;
+
   void add_candle();
   void rollback();
 
@@ -101,19 +138,28 @@ class Portfolio : public Endpoint {
 
   void write_plot_data(const std::string& symbol) const;
 
+  void write_async(std::function<void()> f) const;
+  void await_pages() const;
+
   void write_history() const;
+  void write_ticker(const Ticker& ticker) const;
   void write_tickers() const;
   void write_positions() const;
   void write_index() const;
+  void write_rules() const;
 
   void write_page() const {
     write_index();
     write_tickers();
     write_history();
     write_positions();
+    write_rules();
   }
 
  private:
   void handle_command(const Message& msg);
   void iter();
+
+  void publish_levels(const std::string& symbol, const Ticker& ticker);
+  void monitor_stops();
 };
@@ -51,6 +51,7 @@ class OpenPositions {
 
  public:
   OpenPositions();
+  explicit OpenPositions(Trades trades);  // simulated, no trades file
   double add_trade(const Trade& trade);
   void update_trades();
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/replay_store.h"
 #include "ind/candle.h"
 #include "mt/api.h"
 #include "util/symbols.h"
@@ -13,32 +14,38 @@ struct Candle;
 struct SymbolInfo;
 class TD;
 
-struct Timeline {
-  std::vector<Candle> candles;
-  size_t idx = 0;
-};
-
-using CandleStore = std::unordered_map<std::string, Timeline>;
-
 class Replay {
   TD& td;
 
-  CandleStore candles_by_sym;
+  ReplayStore store;
+  std::unordered_map<std::string, size_t> idx;  // next candle per symbol
 
   size_t n_ticks = 0;
   const size_t calls_per_hour = 4;
 
+  // pins the market clock to the candle the next step hands out
+  void sync_clock() const;
+
  public:
   Replay(TD& td, const Symbols& symbols) noexcept;
 
   TimeSeriesRes time_series(const std::string& symbol,
                             minutes timeframe = H_1) noexcept;
   RealTimeRes real_time(const std::string& symbol,
-                        minutes timeframe = H_1) noexcept;
+                        minutes timeframe = H_1,
+                        Deadline deadline = {}) noexcept;
+  RealTimeBatch real_time(const std::vector<std::string>& symbols,
+                          minutes timeframe = H_1,
+                          Deadline deadline = {}) noexcept;
+
+  // zero-copy columns of the whole series, nullptr if not in the dataset
+  const CandleView* view(const std::string& symbol) const;
 
-  void rollback(const std::string& symbol);
   bool has_data() const;
 
+  // steps taken so far
+  size_t tick() const { return n_ticks; }
+
   void roll_fwd() noexcept;
-  void roll_bwd();
+  void roll_bwd() noexcept;
 };
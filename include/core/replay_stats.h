@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class Stage {
+  Fetch,
+  Compute,
+  Publish,
+  Pages,
+};
+
+inline constexpr size_t N_STAGES = 4;
+
+// Timings of a headless replay. Stage times are summed over the threads
+// that ran them; steps are wall times of whole add_candle cycles.
+class ReplayStats {
+  std::array<std::atomic<int64_t>, N_STAGES> stage_ns{};
+  std::atomic<size_t> n_candles = 0;
+
+  std::mutex mtx;
+  std::vector<double> step_ms;
+
+ public:
+  void add(Stage stage, double ms);
+  void add_candles(size_t n) { n_candles += n; }
+  void add_step(double ms);
+
+  size_t n_steps();
+  void report(double total_s);
+};
+
+// peak resident set of the process, in MB
+double peak_rss_mb();
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "ind/candle.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+inline constexpr auto replay_fname = "private/replay_candles.bin";
+
+// One symbol's candles as columns of the mapped replay file.
+struct CandleView {
+  std::span<const int64_t> time;  // seconds of the local ny time
+  std::span<const double> open;
+  std::span<const double> high;
+  std::span<const double> low;
+  std::span<const double> close;
+  std::span<const int64_t> volume;
+
+  size_t start = 0;  // first candle handed out as real time
+
+  size_t size() const { return time.size(); }
+  bool empty() const { return time.empty(); }
+  Candle operator[](size_t i) const;
+
+  // candles [from, to) as an owned series
+  TimeSeriesRes slice(size_t from, size_t to) const;
+};
+
+struct ReplaySeries {
+  TimeSeriesRes candles;
+  size_t start = 0;
+};
+
+// Read-only columnar replay dataset. A versioned header, a directory of
+// symbols with their column offsets, then per symbol the time, open, high,
+// low, close and volume columns back to back. Mapped once and shared by
+// every replay process reading the same file.
+class ReplayStore {
+  struct Header {
+    char magic[4] = {'F', 'R', 'P', 'L'};
+    uint32_t version = 1;
+    uint64_t n_symbols = 0;
+  };
+
+  struct DirEntry {
+    char symbol[16] = {};
+    uint64_t n = 0;
+    uint64_t start = 0;
+    uint64_t offset = 0;  // of the time column, the rest follow it
+  };
+
+  static constexpr size_t N_COLUMNS = 6;
+
+  void* base = nullptr;
+  size_t sz = 0;
+  std::unordered_map<std::string, CandleView> views;
+
+ public:
+  ReplayStore() = default;
+  explicit ReplayStore(const std::string& filename) noexcept;
+  ~ReplayStore() noexcept;
+
+  ReplayStore(const ReplayStore&) = delete;
+  ReplayStore& operator=(const ReplayStore&) = delete;
+  ReplayStore(ReplayStore&& other) noexcept;
+  ReplayStore& operator=(ReplayStore&& other) noexcept;
+
+  static bool write(
+      const std::string& filename,
+      const std::unordered_map<std::string, ReplaySeries>& series);
+
+  const CandleView* find(const std::string& symbol) const;
+  const auto& all() const { return views; }
+  bool empty() const { return views.empty(); }
+};
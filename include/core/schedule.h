@@ -0,0 +1,80 @@
+#pragma once
+
+#include "core/positions.h"
+#include "util/symbols.h"
+#include "util/times.h"
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Fetch order of an update cycle, most urgent first. Held names always lead,
+// the rest follow the priority column of tickers.csv.
+enum class Tier {
+  Held,
+  High,
+  Medium,
+  Low,
+};
+
+inline constexpr size_t N_TIERS = 4;
+
+Tier tier_of(const SymbolInfo& si, const OpenPositions& positions);
+
+// thread_pool pops from the back, so the returned order is least urgent
+// first. `budget` caps the number of symbols kept, dropping the lowest tiers.
+std::vector<SymbolInfo> by_priority(const Symbols& symbols,
+                                    const OpenPositions& positions,
+                                    size_t budget = SIZE_MAX);
+
+// splits a by_priority queue into batches of at most n, keeping the pop order:
+// the last batch is full and holds the most urgent names.
+std::vector<std::vector<SymbolInfo>> in_batches(std::vector<SymbolInfo> queue,
+                                                size_t n);
+
+struct TierLatency {
+  struct Entry {
+    size_t n = 0;
+    double sum_ms = 0.0;
+    double max_ms = 0.0;
+  };
+
+  void add(Tier tier, double ms);
+  void report(const std::string& tag) const;
+
+ private:
+  mutable std::mutex mtx;
+  std::array<Entry, N_TIERS> entries;
+};
+
+// What the planner needs to know about a ticker to pick its refresh cadence.
+struct RefreshDemand {
+  std::string symbol;
+  bool held = false;
+  double atr_pct = 0.0;    // daily atr over price
+  double proximity = 0.0;  // 0..1, how close the 1h score is to a threshold
+};
+
+// Per-ticker refresh cadence. Every ticker is refreshed at least hourly so no
+// 1h candle is missed; the stop monitor's price polls of held names come off
+// the API budget next, and what's left goes to faster refreshes of the
+// riskiest names, in order of demand.
+class RefreshPlan {
+  std::unordered_map<std::string, minutes> cadence;
+
+ public:
+  minutes tick = H_1;  // main loop interval, the finest cadence handed out
+  seconds monitor{0};  // stop monitor poll interval, 0 if nothing is held
+
+  RefreshPlan() = default;
+  RefreshPlan(std::vector<RefreshDemand> demands,
+              size_t daily_quota,
+              size_t minute_quota,
+              seconds monitor_every);
+
+  minutes cadence_of(const std::string& symbol) const;
+  bool due(const std::string& symbol, LocalTimePoint tp) const;
+};
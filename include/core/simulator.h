@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core/positions.h"
+#include "core/replay_store.h"
+#include "ind/indicators.h"
+#include "ind/ticker.h"
+#include "util/symbols.h"
+#include "util/times.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct EquityPoint {
+  LocalTimePoint time;
+  double equity = 0.0;
+  double cash = 0.0;
+  double drawdown = 0.0;  // fraction below the running peak
+};
+
+struct SimResult {
+  double capital = 0.0;
+  std::vector<EquityPoint> equity;
+  Trades trades;
+  double max_drawdown = 0.0;
+  size_t n_steps = 0;
+
+  double final_equity() const {
+    return equity.empty() ? capital : equity.back().equity;
+  }
+
+  // data/sim_equity.csv and data/sim_trades.csv
+  void write_csv() const;
+  void report(double total_s) const;
+};
+
+// Walks the replay dataset forward an hourly step at a time through the same
+// Ticker pipeline the live portfolio runs, trading simulated positions.
+// Orders are decided on a candle's close and filled on the next candle of
+// that symbol: entries and exits at its open, adds and trims only if it
+// reaches their trigger. Tickers step in parallel, everything that depends
+// on their order runs in symbol order, so a run is deterministic.
+class Simulator {
+  struct Order {
+    std::string symbol;
+    Action action;
+    double qty = 0.0;
+    double trigger = 0.0;  // 0 for a market order
+    std::string remark;
+  };
+
+  const ReplayStore& store;
+
+  Indicators spy;
+  OpenPositions positions;
+  std::map<std::string, Ticker> tickers;
+
+  std::map<std::string, size_t> idx;  // next candle per symbol
+  size_t spy_idx = 0;
+  std::vector<Order> orders;
+
+  double cash;
+  double peak;
+  SimResult res;
+
+  LocalTimePoint next_time() const;
+  void fill(LocalTimePoint t);
+  void step(const std::vector<std::string>& symbols);
+  void decide(const std::vector<std::string>& symbols);
+  void mark(LocalTimePoint t);
+
+ public:
+  // every ticker starts with `warmup` candles of history, symbols with less
+  // are left out
+  Simulator(const Symbols& symbols,
+            const ReplayStore& store,
+            double capital,
+            size_t warmup) noexcept;
+
+  Simulator(const Simulator&) = delete;
+  Simulator& operator=(const Simulator&) = delete;
+
+  SimResult run();
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "core/replay_store.h"
+#include "sig/signals.h"
+#include "util/config.h"
+#include "util/symbols.h"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Search space of a sweep, read from json. In a grid every combination of
+// the listed values is tried; in a random search `n` configs are drawn with
+// each parameter uniform between the smallest and largest value listed.
+struct SweepSpec {
+  std::string mode = "grid";
+  size_t n = 100;
+  uint64_t seed = 1;
+  std::map<std::string, std::vector<double>> params;
+
+  static std::optional<SweepSpec> read(const std::string& path);
+};
+
+struct SweepTrial {
+  std::vector<std::pair<std::string, double>> params;
+  SignalConfig sig;
+  RiskConfig risk;
+};
+
+struct SweepResult {
+  size_t trial = 0;
+
+  size_t n_entry = 0;        // entry ratings
+  size_t n_entry_right = 0;  // followed by a higher close a day later
+  size_t n_exit = 0;
+
+  size_t n_trades = 0;
+  size_t n_wins = 0;
+  double pnl_pct = 0.0;  // sum of trade returns
+  double pnl_r = 0.0;    // sum of trade returns in units of initial risk
+};
+
+// Parameter sweep over SignalConfig and RiskConfig. Candles, indicators,
+// trends, S/R, backtest stats and the reasons and hints at every candle are
+// computed once per symbol, walking forward with S/R and stats refit every
+// `refit_days` from past candles only; each config only re-weighs and
+// re-rates that evidence and replays a long-only trade per symbol: in at the
+// next open on an entry, out at a stop, a target, an exit rating or after
+// max_hold_days.
+class Sweep {
+  static constexpr size_t refit_days = 5;
+
+  struct Series {
+    std::string symbol;
+    std::vector<Evidence> evidence;
+    std::vector<double> open, high, low, close, atr;
+    std::vector<double> fwd;  // return to the close a day later, NaN past end
+  };
+
+  std::vector<Series> series;
+
+  SweepResult evaluate(size_t trial, const SweepTrial& t) const;
+
+ public:
+  // evidence starts `warmup` candles into each symbol
+  Sweep(const Symbols& symbols, const ReplayStore& store, size_t warmup);
+
+  std::vector<SweepResult> run(const std::vector<SweepTrial>& trials) const;
+};
+
+// the configs of a spec, starting from `sig` and `risk`; parameters that
+// aren't a field of either, or that change the shared work, are rejected
+std::vector<SweepTrial> sweep_trials(const SweepSpec& spec,
+                                     const SignalConfig& sig,
+                                     const RiskConfig& risk);
+
+// ranked by pnl, to data/sweep.csv and the top of it to stdout
+void report_sweep(const std::vector<SweepTrial>& trials,
+                  std::vector<SweepResult> results);
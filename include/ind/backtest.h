@@ -1,5 +1,7 @@
 #pragma once
 
+#include "util/times.h"
+
 #include <cstdlib>
 #include <utility>
 #include <vector>
@@ -47,6 +49,7 @@ struct SignalStats {
 };
 
 struct IndicatorsTrends;
+struct RuleStats;
 
 /**
  * @brief Backtesting engine for evaluating trading signal performance over
@@ -69,7 +72,11 @@ class Backtest {
  public:
   Backtest(const IndicatorsTrends& ind);
 
+  minutes interval() const;
+
+  // `prof` accounts every call of signal_fn, if set
   template <typename T, typename Func>
-  std::pair<T, SignalStats> get_stats(Func signal_fn) const;
+  std::pair<T, SignalStats> get_stats(Func signal_fn,
+                                      RuleStats* prof = nullptr) const;
 };
 
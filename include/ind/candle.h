@@ -3,6 +3,8 @@
 #include "util/times.h"
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 struct Candle {
   LocalTimePoint datetime;
@@ -15,7 +17,10 @@ struct Candle {
   std::string day() const { return std::format("{:%F}", time()); }
   double price() const { return close; }
   LocalTimePoint time() const { return datetime; }
+
+  bool operator==(const Candle&) const = default;
 };
 
 using TimeSeriesRes = std::vector<Candle>;
 using RealTimeRes = std::pair<Candle, Candle>;
+using RealTimeBatch = std::unordered_map<std::string, RealTimeRes>;
@@ -10,6 +10,7 @@
 #include "util/times.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <deque>
 #include <iterator>
@@ -17,6 +18,23 @@
 #include <string>
 #include <vector>
 
+// Size and last value of a series. Restoring one undoes a push_back, or a
+// pop_back followed by a push_back.
+struct SeriesTail {
+  size_t n = 0;
+  double last = 0.0;
+};
+
+inline SeriesTail tail_of(const std::vector<double>& v) {
+  return {v.size(), v.empty() ? 0.0 : v.back()};
+}
+
+inline void restore_tail(std::vector<double>& v, SeriesTail t) {
+  v.resize(t.n);
+  if (t.n > 0)
+    v.back() = t.last;
+}
+
 struct EMA {
   std::vector<double> values;
 
@@ -31,25 +49,49 @@ struct EMA {
   void push_back(const Candle& candle) noexcept;
   void push_back(double price) noexcept;
   void pop_back() noexcept { values.pop_back(); }
+
+  SeriesTail tail() const { return tail_of(values); }
+  void restore(SeriesTail t) { restore_tail(values, t); }
 };
 
 struct RSI {
   std::vector<double> values;
 
+  // what the next push_back continues from
+  struct State {
+    double last_price = 0.0;
+    double avg_gain = 0.0;
+    double avg_loss = 0.0;
+  };
+
+  struct Tail {
+    SeriesTail values;
+    State state, before;
+  };
+
  private:
   int period;
 
   std::deque<double> gains;
   std::deque<double> losses;
-  double last_price = 0.0;
-  double avg_gain = 0.0;
-  double avg_loss = 0.0;
+  State state;
+  State before;  // ahead of the last push_back, restored by pop_back
 
  public:
   RSI(const std::vector<Candle>& candles, int period = 14) noexcept;
 
   void push_back(const Candle& candle) noexcept;
-  void pop_back() noexcept { values.pop_back(); }
+  void pop_back() noexcept {
+    values.pop_back();
+    state = before;
+  }
+
+  Tail tail() const { return {tail_of(values), state, before}; }
+  void restore(const Tail& t) {
+    restore_tail(values, t.values);
+    state = t.state;
+    before = t.before;
+  }
 
   bool rising() const;
 };
@@ -71,6 +113,23 @@ struct MACD {
 
   void push_back(const Candle& candle) noexcept;
   void pop_back() noexcept;
+
+  struct Tail {
+    SeriesTail line, hist;
+    SeriesTail fast, slow, signal;
+  };
+
+  Tail tail() const {
+    return {tail_of(macd_line), tail_of(histogram), fast_ema.tail(),
+            slow_ema.tail(), signal_ema.tail()};
+  }
+  void restore(const Tail& t) {
+    restore_tail(macd_line, t.line);
+    restore_tail(histogram, t.hist);
+    fast_ema.restore(t.fast);
+    slow_ema.restore(t.slow);
+    signal_ema.restore(t.signal);
+  }
 };
 
 struct ATR {
@@ -89,6 +148,12 @@ struct ATR {
     prev_close = close;
     values.pop_back();
   }
+
+  SeriesTail tail() const { return tail_of(values); }
+  void restore(SeriesTail t, double close) {
+    restore_tail(values, t);
+    prev_close = close;
+  }
 };
 
 struct Pullback {
@@ -123,6 +188,34 @@ struct IndicatorsCore {
     return idx < 0 ? candles.size() + idx : idx;
   }
 
+  // the last values of every series, enough to undo a step without
+  // recomputing anything
+  struct Tail {
+    size_t n = 0;
+    Candle candle;
+    SeriesTail ema9, ema21, ema50;
+    RSI::Tail rsi;
+    MACD::Tail macd;
+    SeriesTail atr;
+  };
+
+  Tail tail() const {
+    return {candles.size(), candles.back(), _ema9.tail(),
+            _ema21.tail(),  _ema50.tail(),  _rsi.tail(),
+            _macd.tail(),   _atr.tail()};
+  }
+
+  void restore(const Tail& t) {
+    candles.resize(t.n);
+    candles.back() = t.candle;
+    _ema9.restore(t.ema9);
+    _ema21.restore(t.ema21);
+    _ema50.restore(t.ema50);
+    _rsi.restore(t.rsi);
+    _macd.restore(t.macd);
+    _atr.restore(t.atr, t.candle.close);
+  }
+
  public:
   auto size() const { return candles.size(); }
   LocalTimePoint time(int idx) const { return candles[sanitize(idx)].time(); }
@@ -210,14 +303,11 @@ struct Stats {
   std::map<HintType, SignalStats> hint;
 
   Stats() = default;
-  Stats(const IndicatorsTrends& ind) : Stats{Backtest{ind}} {}
+  Stats(const IndicatorsTrends& ind);
 
  private:
   static std::map<ReasonType, SignalStats> get_reason_stats(const Backtest& bt);
   static std::map<HintType, SignalStats> get_hint_stats(const Backtest& bt);
-
-  Stats(Backtest&& bt)
-      : reason{get_reason_stats(bt)}, hint{get_hint_stats(bt)} {}
 };
 
 struct Indicators : public IndicatorsTrends {
@@ -244,6 +334,21 @@ struct Indicators : public IndicatorsTrends {
   void push_back(const Candle& candle) noexcept;
   void pop_back() noexcept;
 
+  // state ahead of a step; support, resistance and stats aren't touched by
+  // push_back, so they aren't kept
+  struct Undo {
+    Tail tail;
+    Trends trends;
+    Signal signal;
+  };
+
+  Undo undo_point() const { return {tail(), trends, signal}; }
+  void undo(Undo&& u) {
+    restore(u.tail);
+    trends = std::move(u.trends);
+    signal = std::move(u.signal);
+  }
+
   LocalTimePoint plot(const std::string& sym, const std::string& time) const;
 
   Signal get_signal(int idx) const;
@@ -272,7 +377,29 @@ struct Metrics {
   Metrics& operator=(Metrics&&) = default;
 
   bool push_back(const Candle& next, const Position* position) noexcept;
-  void rollback() noexcept;
+
+  struct Undo {
+    size_t n = 0;
+    Candle last;
+    std::array<Indicators::Undo, 3> ind;
+    const Position* position = nullptr;
+  };
+
+  Undo undo_point() const {
+    return {candles.size(),
+            candles.back(),
+            {ind_1h.undo_point(), ind_4h.undo_point(), ind_1d.undo_point()},
+            position};
+  }
+
+  void undo(Undo&& u) {
+    candles.resize(u.n);
+    candles.back() = u.last;
+    ind_1h.undo(std::move(u.ind[0]));
+    ind_4h.undo(std::move(u.ind[1]));
+    ind_1d.undo(std::move(u.ind[2]));
+    position = u.position;
+  }
 
   auto last_price() const { return ind_1h.price(-1); }
   auto last_updated() const { return ind_1h.time(-1); }
@@ -4,7 +4,9 @@
 #include "indicators.h"
 #include "risk/risk.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 #include "util/symbols.h"
+#include "util/undo_log.h"
 
 #include <iostream>
 
@@ -19,10 +21,28 @@ struct Ticker {
   CombinedSignal signal;
   Risk risk;
 
+  // bumped whenever signal, risk or position may have changed, the pages
+  // re-render what they take from the ticker only when it moves
+  uint64_t version = 0;
+
  private:
   friend class Portfolio;
+  friend class Simulator;
+
+  // a replay step restored as is, signal and risk included
+  struct Snapshot {
+    Metrics::Undo metrics;
+    CombinedSignal signal;
+    Risk risk;
+  };
 
+  UndoLog<Snapshot> undo_log;
+
+  // everything but the signal and risk themselves is scratch, push_back and
+  // update_position open the scope around the metrics update too
   void calc_signal() {
+    ScratchScope _;
+    version++;
     signal = CombinedSignal{metrics, ev};
     risk = Risk{metrics, spy, LocalTimePoint{}, signal, open_positions, ev};
     signal.apply_stop_hit(risk.get_stop_hit(metrics));
@@ -45,20 +65,32 @@ struct Ticker {
 
   template <typename... Args>
   void update_position(Args&&... args) {
+    ScratchScope _;
     metrics.update_position(std::forward<Args>(args)...);
     calc_signal();
   }
 
   template <typename... Args>
   void push_back(Args&&... args) {
+    ScratchScope _;
     metrics.push_back(std::forward<Args>(args)...);
     calc_signal();
   }
 
-  template <typename... Args>
-  void rollback(Args&&... args) {
-    metrics.rollback(std::forward<Args>(args)...);
-    calc_signal();
+  void save_undo(size_t step) {
+    undo_log.push(step, {metrics.undo_point(), signal, risk});
+  }
+
+  // false if the ticker didn't change in `step`
+  bool undo(size_t step) {
+    auto s = undo_log.pop(step);
+    if (!s)
+      return false;
+    metrics.undo(std::move(s->metrics));
+    signal = std::move(s->signal);
+    risk = std::move(s->risk);
+    version++;
+    return true;
   }
 
   void write_plot_data() const;
@@ -1,36 +1,43 @@
 #pragma once
 
 #include "ind/candle.h"
+#include "mt/http.h"
+#include "mt/rate_limiter.h"
 #include "util/times.h"
 
-#include <deque>
-#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-struct APIKey {
-  const std::string key;
-  int daily_calls = 0;
-  std::deque<TimePoint> call_timestamps = {};  // to enforce 8/min
-};
-
 inline constexpr int MAX_OUTPUT_SIZE = 5000;
+inline constexpr int API_TOKENS = 800;
+inline constexpr int MAX_CALLS_MIN = 8;
 
 class TD {
-  std::vector<APIKey> keys;
-  int idx = 0;
-  std::mutex mtx;
+  std::vector<std::string> keys;
+  RateLimiter<MAX_CALLS_MIN> limiter;  // one bucket per key
 
  public:
   const minutes interval;
 
  private:
-  int try_get_key();
-  std::string get_key();
+  std::string get_key(int credits = 1, Deadline deadline = {});
 
+  std::optional<http::Request> request(const std::string& symbols,
+                                       int credits,
+                                       minutes timeframe,
+                                       size_t output_size,
+                                       Deadline deadline);
   TimeSeriesRes api_call(const std::string& symbol,
                          minutes timeframe,
-                         size_t output_size = MAX_OUTPUT_SIZE);
+                         size_t output_size = MAX_OUTPUT_SIZE,
+                         Deadline deadline = {});
+  std::unordered_map<std::string, TimeSeriesRes> batch_call(
+      const std::vector<std::string>& symbols,
+      minutes timeframe,
+      size_t output_size,
+      Deadline deadline);
 
  public:
   TD(size_t n_tickers);
@@ -38,6 +45,17 @@ class TD {
   TimeSeriesRes time_series(const std::string& symbol,
                             minutes timeframe = H_1) noexcept;
   RealTimeRes real_time(const std::string& symbol,
-                        minutes timeframe = H_1) noexcept;
+                        minutes timeframe = H_1,
+                        Deadline deadline = {}) noexcept;
+  RealTimeBatch real_time(const std::vector<std::string>& symbols,
+                          minutes timeframe = H_1,
+                          Deadline deadline = {}) noexcept;
+  double price(const std::string& symbol) noexcept;
+  std::unordered_map<std::string, double> prices(
+      const std::vector<std::string>& symbols) noexcept;
   LocalTimePoint latest_datetime() noexcept;
+
+  size_t remaining_calls();
+  size_t daily_quota() const { return keys.size() * API_TOKENS; }
+  size_t minute_quota() const { return keys.size() * MAX_CALLS_MIN; }
 };
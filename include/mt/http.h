@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cpr/cpr.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace http {
+
+struct Request {
+  std::string url;
+  cpr::Parameters params = {};
+  cpr::Header header = {};
+};
+
+cpr::Response get(const Request& req);
+
+// up to `max_in_flight` requests at once, multiplexed by curl multi on the
+// calling thread. responses come back in request order.
+std::vector<cpr::Response> get_all(const std::vector<Request>& reqs,
+                                   size_t max_in_flight = SIZE_MAX);
+
+// completes on cpr's async pool, the caller collects the response
+cpr::AsyncResponse post_async(const std::string& url, cpr::Payload payload);
+
+}  // namespace http
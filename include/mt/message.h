@@ -1,5 +1,7 @@
 #pragma once
 
+#include "util/telemetry.h"
+
 #include <condition_variable>
 #include <deque>
 #include <functional>
@@ -45,11 +47,17 @@ class MessageQueue {
   mutable std::mutex mtx;
   bool stopped = false;
 
+  Gauge* depth = nullptr;
+
  public:
+  void track(Gauge& g) { depth = &g; }
+
   template <typename... Args>
   void push(Args&&... args) {
     std::lock_guard lk{mtx};
     msgs.emplace_back(std::forward<Args>(args)...);
+    if (depth)
+      depth->set(msgs.size());
     cv.notify_all();
   }
 
@@ -60,6 +68,8 @@ class MessageQueue {
       return std::nullopt;
     auto msg = std::move(msgs.front());
     msgs.pop_front();
+    if (depth)
+      depth->set(msgs.size());
     return msg;
   }
 
@@ -94,7 +104,11 @@ class Endpoint {
   MessageQueue msg_q;
   std::unordered_map<id_t, std::vector<Message>> unsent;
 
-  Endpoint(id_t id) : id{id} {}
+  Endpoint(id_t id) : id{id} {
+    msg_q.track(telemetry.gauge("fin_message_queue_depth",
+                                "Messages waiting for an endpoint",
+                                {{"endpoint", std::to_string(id)}}));
+  }
   bool is_stopped() const { return msg_q.is_stopped(); }
 
   void send_to_broker(Message&& msg);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+// Serves the telemetry registry in the prometheus text format to a local
+// scraper. `addr` is a port on 127.0.0.1, or the path of a unix socket.
+class MetricsServer {
+  int fd = -1;
+  std::string socket_path;  // unlinked on exit, empty for tcp
+  std::atomic<bool> stopped = false;
+  std::thread t;
+
+  void serve();
+  void respond(int client);
+
+ public:
+  explicit MetricsServer(const std::string& addr) noexcept;
+  ~MetricsServer() noexcept;
+
+  MetricsServer(const MetricsServer&) = delete;
+  MetricsServer& operator=(const MetricsServer&) = delete;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "sleeper.h"
+#include "util/times.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <vector>
+
+// Per-key credit buckets for an api limited to N credits a minute and
+// `per_day` credits a UTC day. A minute credit returns to its bucket exactly
+// a minute after it's spent, so no sliding minute ever sees more than N.
+// Waiters are served in arrival order, and the one at the head sleeps until
+// the instant the next credit frees up.
+template <size_t N>
+class RateLimiter {
+  struct Bucket {
+    std::array<TimePoint, N> returns{};  // ring, in spend order
+    size_t head = 0;
+    int used_today = 0;
+
+    TimePoint ready_at(int credits) const {
+      return returns[(head + credits - 1) % N];
+    }
+
+    void spend(int credits, TimePoint now) {
+      for (int i = 0; i < credits; i++) {
+        returns[head] = now + minutes(1);
+        head = (head + 1) % N;
+      }
+      used_today += credits;
+    }
+  };
+
+  const int per_day;
+  std::vector<Bucket> buckets;
+  size_t idx = 0;
+
+  std::mutex mtx;
+  std::condition_variable cv;
+
+  uint64_t next_ticket = 0;
+  uint64_t serving = 0;
+  std::set<uint64_t> abandoned;
+
+  std::chrono::sys_days day{};
+
+  void roll_day() {
+    auto today = std::chrono::floor<days>(SysClock::now());
+    if (today == day)
+      return;
+    day = today;
+    for (auto& b : buckets)
+      b.used_today = 0;
+  }
+
+  TimePoint next_day() const {
+    auto left = day + days{1} - SysClock::now();
+    return Clock::now() + std::chrono::duration_cast<Clock::duration>(left);
+  }
+
+  void advance() {
+    serving++;
+    while (abandoned.erase(serving))
+      serving++;
+    cv.notify_all();
+  }
+
+  void leave(uint64_t ticket) {
+    if (ticket == serving)
+      advance();
+    else
+      abandoned.insert(ticket);
+  }
+
+ public:
+  RateLimiter(size_t n_keys, int per_day) : per_day{per_day}, buckets(n_keys) {
+    roll_day();
+  }
+
+  // index of the key to spend `credits` on, or -1 if the deadline passes or
+  // shutdown is requested first
+  int acquire(int credits, Deadline deadline = {}) {
+    if (buckets.empty() || credits < 1 || credits > static_cast<int>(N))
+      return -1;
+
+    std::unique_lock lk{mtx};
+    auto ticket = next_ticket++;
+
+    // shutdown has its own cv, so waits are capped to notice it
+    constexpr auto poll = seconds(1);
+
+    while (ticket != serving) {
+      if (deadline.expired() || sleeper.should_shutdown()) {
+        leave(ticket);
+        return -1;
+      }
+      auto until = std::min(deadline.at, Clock::now() + poll);
+      cv.wait_until(lk, until);
+    }
+
+    while (true) {
+      roll_day();
+      auto now = Clock::now();
+      auto ready = TimePoint::max();
+
+      for (size_t i = 0; i < buckets.size(); i++) {
+        auto k = idx;
+        idx = (idx + 1) % buckets.size();
+
+        auto& b = buckets[k];
+        if (b.used_today + credits > per_day)
+          continue;
+
+        auto at = b.ready_at(credits);
+        if (at <= now) {
+          b.spend(credits, now);
+          advance();
+          return static_cast<int>(k);
+        }
+        ready = std::min(ready, at);
+      }
+
+      if (ready == TimePoint::max())
+        ready = next_day();
+
+      if (deadline.expired() || sleeper.should_shutdown()) {
+        leave(ticket);
+        return -1;
+      }
+
+      auto until = std::min({ready, deadline.at, now + poll});
+      cv.wait_until(lk, until);
+    }
+  }
+
+  size_t remaining_today() {
+    std::lock_guard _{mtx};
+    roll_day();
+    size_t n = 0;
+    for (auto& b : buckets)
+      n += std::max(per_day - b.used_today, 0);
+    return n;
+  }
+};
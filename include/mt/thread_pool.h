@@ -1,6 +1,7 @@
 #pragma once
 
 #include "sleeper.h"
+#include "util/telemetry.h"
 
 #include <concepts>
 #include <condition_variable>
@@ -14,6 +15,20 @@
 #include <type_traits>
 #include <vector>
 
+// shared by every pool, busy over threads is the utilization
+struct PoolTelemetry {
+  Gauge& threads = telemetry.gauge("fin_pool_threads", "Pool worker threads");
+  Gauge& busy = telemetry.gauge("fin_pool_busy_threads",
+                                "Pool workers running an item");
+  Counter& items =
+      telemetry.counter("fin_pool_items_total", "Items run by pool workers");
+};
+
+inline PoolTelemetry& pool_telemetry() {
+  static PoolTelemetry t;
+  return t;
+}
+
 template <typename T>
   requires std::is_move_assignable_v<T> && std::is_move_constructible_v<T>
 class thread_pool {
@@ -25,8 +40,11 @@ class thread_pool {
   const Func func;
 
   std::vector<T> vals;
+  const size_t capacity = 0;  // pending items before emplace blocks, 0 = none
+
   mutable std::mutex mtx;
   std::condition_variable cv;
+  std::condition_variable cv_space;
   bool stopped = false;
   bool started = false;
 
@@ -37,20 +55,32 @@ class thread_pool {
       return std::nullopt;
     auto t = std::move(vals.back());
     vals.pop_back();
+    lk.unlock();
+    cv_space.notify_one();
     return t;
   }
 
   void worker_loop() {
+    auto& pt = pool_telemetry();
+    pt.threads.add(1);
     while (!sleeper.should_shutdown()) {
       auto t_opt = pop();
       if (!t_opt)
         break;
+      pt.busy.add(1);
       auto cont = func(std::move(*t_opt));
+      pt.busy.add(-1);
+      pt.items.inc();
       if (!cont) {
         stop();
         break;
       }
     }
+    // a producer blocked in emplace would otherwise wait on a full pool
+    // that nobody drains anymore
+    if (sleeper.should_shutdown())
+      stop();
+    pt.threads.add(-1);
     latch.count_down();
   }
 
@@ -60,14 +90,19 @@ class thread_pool {
       stopped = true;
     }
     cv.notify_all();
+    cv_space.notify_all();
   }
 
  public:
-  thread_pool(size_t n_threads, Func func, std::vector<T> vec) noexcept
+  thread_pool(size_t n_threads,
+              Func func,
+              std::vector<T> vec,
+              size_t capacity = 0) noexcept
       : n_threads{n_threads},
         latch{static_cast<ptrdiff_t>(n_threads)},
         func{func},
-        vals{std::move(vec)}  //
+        vals{std::move(vec)},
+        capacity{capacity}  //
   {
     threads.reserve(n_threads);
     for (size_t i = 0; i < n_threads; i++)
@@ -89,11 +124,20 @@ class thread_pool {
   thread_pool(thread_pool&&) = delete;
   thread_pool& operator=(thread_pool&&) = delete;
 
+  // blocks while the pool holds `capacity` pending items, so a fast producer
+  // stage can't run arbitrarily far ahead of the workers. on shutdown the
+  // item is dropped
   template <typename... Args>
     requires std::constructible_from<T, Args...>
   void emplace(Args&&... args) {
     {
-      std::lock_guard lk{mtx};
+      std::unique_lock lk{mtx};
+      cv_space.wait(lk, [this] {
+        return stopped || capacity == 0 || vals.size() < capacity ||
+               sleeper.should_shutdown();
+      });
+      if (sleeper.should_shutdown())
+        return;
       if (stopped)
         throw std::runtime_error("added work to stopped thread_pool");
       vals.emplace_back(std::forward<Args>(args)...);
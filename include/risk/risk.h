@@ -6,6 +6,16 @@
 #include "stop_loss.h"
 #include "target.h"
 
+// steps of the scaling rules, see to_str<target>(Rationale<ScalingWhy>, ...)
+enum class ScalingWhy : uint8_t {
+  CanAdd,              // shares, price
+  Trim,                // shares, price
+  NoAction,            //
+  BreakingResistance,  //
+  HalfwayToStop,       //
+  AtSupport,           //
+};
+
 struct ScalingRules {
   // Scale up
   bool can_add = false;
@@ -17,7 +27,7 @@ struct ScalingRules {
   double trim_trigger_price = 0.0;
   double trim_size_shares = 0.0;
 
-  std::string rationale = "";
+  Rationale<ScalingWhy> rationale;
 
   ScalingRules() noexcept = default;
   ScalingRules(const Metrics& m,
@@ -26,6 +36,25 @@ struct ScalingRules {
                const PositionSizing& initial_sizing);
 };
 
+// the trade decision and its checks, rendered together with the stop,
+// sizing, target and scaling rationales
+enum class RiskWhy : uint8_t {
+  // decision
+  Take,            //
+  Skip,            //
+  EarningsClose,   //
+  SizingRejected,  //
+  RRTooLow,        // r:r
+  TrendingDown,    //
+
+  // checks
+  Market,    // regime
+  Earnings,  // days until
+  Stop,      // price, %
+  Risk,      // %
+  Target,    // price, r:r
+};
+
 class Risk {
   MarketRegime regime;
 
@@ -38,7 +67,7 @@ class Risk {
   // Overall assessment
   bool should_take_trade = false;
   bool is_near_earnings = false;
-  std::string overall_rationale = "";
+  Rationale<RiskWhy> overall_rationale;
 
   Risk() noexcept = default;
   Risk(const Metrics& m,
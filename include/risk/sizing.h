@@ -4,6 +4,7 @@
 #include "ind/indicators.h"
 #include "sig/combined_signal.h"
 #include "stop_loss.h"
+#include "util/rationale.h"
 
 enum class Recommendation {
   StrongBuy,  // 0.7-1.0% risk
@@ -12,6 +13,37 @@ enum class Recommendation {
   Avoid       // No position
 };
 
+// steps of the sizing, see to_str<target>(Rationale<SizingWhy>, ...)
+enum class SizingWhy : uint8_t {
+  // reasons
+  DailyLimit,     //
+  WeakSignal,     //
+  PortfolioFull,  //
+  Rec,            // recommendation
+  RiskPct,        // % risk
+  Shares,         // shares, capital
+
+  // details
+  PositionsToday,  // opened today, daily limit
+  TargetRiskLow,   // % target risk
+  Deployed,        // % risk deployed
+  StopDistance,    // $ to the stop
+  RiskPerShare,    // $ per share
+
+  // adjustments
+  HighCorr,        // spy correlation
+  Hedge,           // spy correlation
+  Corr,            // spy correlation
+  HighVol,         // % daily atr
+  ElevatedVol,     // % daily atr
+  Vol,             // % daily atr
+  PortfolioLimit,  // % risk available
+  PositionsOpen,   // open positions
+
+  // context
+  Portfolio,  // open positions, % risk deployed, % risk after
+};
+
 struct PositionSizing {
   Recommendation rec = Recommendation::Avoid;
 
@@ -35,7 +67,7 @@ struct PositionSizing {
   double daily_atr_pct = 0.0;
   int similar_positions = 0;
 
-  std::string rationale = "";
+  Rationale<SizingWhy> rationale;
 
   PositionSizing() = default;
   PositionSizing(const Metrics& m,
@@ -2,6 +2,7 @@
 
 #include "ind/indicators.h"
 #include "sig/signal_types.h"
+#include "util/rationale.h"
 
 enum class MarketRegime {
   TRENDING_UP,
@@ -19,6 +20,24 @@ enum class StopContext {
   SCALE_UP_ENTRY      // Adding shares to existing position
 };
 
+// steps of the stop choice, see to_str<target>(Rationale<StopWhy>, StopLoss)
+enum class StopWhy : uint8_t {
+  Context,       // context, day held
+  UsingSupport,  //
+  UsingAtr,      //
+  Stop,          // stop, % below price, context
+  Tight,         //
+  Moderate,      //
+  Loose,         //
+  Wider,         // % wider for the first days
+  Regime,        // regime
+  AtrStop,       // atr stop, multiplier, regime adjustment
+  SupportStop,   // support stop, % buffer
+  FromMax,       // max price seen, trailing adjustment
+  RegimeAdj,     // % added for the regime
+  DailyVol,      // daily atr %
+};
+
 struct StopLoss {
  private:
   StopContext context;
@@ -46,7 +65,7 @@ struct StopLoss {
 
  public:
   // Metadata for display
-  std::string rationale = "";
+  Rationale<StopWhy> rationale;
 
   StopLoss() noexcept = default;
   StopLoss(const Metrics& m,
@@ -3,6 +3,7 @@
 #include "ind/indicators.h"
 #include "sizing.h"
 #include "stop_loss.h"
+#include "util/rationale.h"
 
 enum class TargetStrategy {
   CONSERVATIVE,  // 1.5:1 R:R
@@ -10,6 +11,27 @@ enum class TargetStrategy {
   AGGRESSIVE     // 3.0:1 R:R
 };
 
+// steps of the target choice, see to_str<target>(Rationale<TargetWhy>, ...)
+enum class TargetWhy : uint8_t {
+  // reasons
+  Strategy,         // strategy
+  UsingResistance,  // timeframe
+  UsingSecond,      // timeframe
+  ResTooClose,      //
+  AtrLimited,       //
+  RRTarget,         // r:r
+  Capped,           //
+
+  // details
+  Resistance,     // timeframe, price, % room
+  NoResistance,   //
+  AtrProjection,  // price, days
+  Target,         // price, %
+  RR,             // r:r
+  BelowMinRR,     //
+  ForecastOnly,   // % expected
+};
+
 struct ProfitTarget {
   // Primary targets
   double initial_target = 0.0;
@@ -32,7 +54,7 @@ struct ProfitTarget {
   double atr_projection = 0.0;
   int expected_days_to_target = 0;
 
-  std::string rationale = "";
+  Rationale<TargetWhy> rationale;
 
   ProfitTarget() noexcept = default;
   ProfitTarget(const Metrics& m,
@@ -2,14 +2,61 @@
 
 #include "filters.h"
 #include "signals.h"
+#include "util/rationale.h"
 
 struct StopLoss;
 struct Event;
 
+// steps of the contextual rating, see to_str<target>(Rationale<SignalWhy>,
+// CombinedSignal). Reasons are joined, context notes appended as they are.
+enum class SignalWhy : uint8_t {
+  // 1h entry
+  H1Entry,
+  D1Confirms,
+  D1Conflicts,
+  D1Neutral,
+  H4Confirms,
+  H4Conflicts,
+  H4Neutral,
+  FiltersExcellent,
+  FiltersBearish,
+  FiltersMixed,
+
+  // 1h watchlist
+  H1Watchlist,
+  HtfUpgrade,
+  D1Upgrade,
+  HtfBearish,
+  HtfMixed,
+
+  // 1h exit
+  H1Exit,
+  HtfConfirmsExit,
+  D1DowngradesExit,
+  FiltersConfirmBearish,
+
+  // 1h neutral or mixed
+  NeutralButBullish,
+  NeutralPotential,
+  HtfStrongBearish,
+  AllNeutral,
+
+  // position adjustments
+  Disqualified,
+  HoldCautiously,
+  NoPositionToExit,
+
+  // context
+  StopHit,
+  TimeExit,
+  NearStop,
+  EarningsProximity,
+};
+
 struct CombinedSignal {
   Rating type = Rating::None;
   Score score;
-  std::string rationale;
+  Rationale<SignalWhy> rationale;
 
   StopHit stop_hit;
   Filters filters;
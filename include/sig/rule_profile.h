@@ -0,0 +1,110 @@
+#pragma once
+
+#include "util/alloc_hook.h"
+#include "util/times.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+// signal() builds reasons and hints on the live path, Stats replays every
+// rule over the lookback on the backtest path
+enum class RulePath {
+  Live,
+  Backtest,
+};
+
+// Calls of one rule on one path and timeframe. Latencies go into log-linear
+// buckets of ns, four per power of two, for the p99.
+struct RuleStats {
+  static constexpr size_t N_SUB = 4;
+  static constexpr size_t N_BUCKETS = 40 * N_SUB;  // up to ~1000s
+
+  std::atomic<uint64_t> calls = 0;
+  std::atomic<uint64_t> fires = 0;
+  std::atomic<uint64_t> ns = 0;
+  std::atomic<uint64_t> allocs = 0;
+  std::array<std::atomic<uint64_t>, N_BUCKETS> hist{};
+
+  void add(uint64_t ns, bool fired, uint64_t allocs);
+  double p99_ns() const;
+};
+
+struct RuleRow {
+  std::string kind;  // reason, hint or filter
+  std::string name;
+  RulePath path;
+  minutes timeframe;  // 0 if the rule sees every timeframe
+
+  uint64_t calls;
+  double fire_rate;
+  double total_ms;
+  double avg_ns;
+  double p99_ns;
+  double allocs_per_call;
+};
+
+// Optional per-rule profiling of the reason, hint and filter evaluators.
+// Rules are registered once per table, and while profiling is off slot()
+// returns nullptr and a rule costs one atomic load.
+class RuleProfiler {
+ public:
+  static constexpr size_t MAX_RULES = 64;
+  static constexpr size_t N_TIMEFRAMES = 4;  // 1h, 4h, 1d, everything else
+
+ private:
+  static constexpr size_t N_SLOTS = MAX_RULES * 2 * N_TIMEFRAMES;
+
+  std::atomic<bool> on = false;
+
+  std::mutex mtx;
+  std::array<const char*, MAX_RULES> kinds{};
+  std::array<const char*, MAX_RULES> names{};
+  size_t n_rules = 0;
+  std::unique_ptr<std::array<RuleStats, N_SLOTS>> stats;
+
+  static size_t tf_idx(minutes tf);
+
+ public:
+  void enable(bool en);
+  bool enabled() const { return on.load(std::memory_order_acquire); }
+
+  // registers a table of rules in order, returns the id of the first
+  size_t add(const char* kind, std::span<const char* const> rule_names);
+
+  RuleStats* slot(size_t rule, RulePath path, minutes tf);
+
+  // every slot that ran, most total time first
+  std::vector<RuleRow> rows();
+};
+
+inline RuleProfiler rule_profiler;
+
+// calls f(args...) and accounts it to `s` unless it's null
+template <typename F, typename... Args>
+inline auto profiled(RuleStats* s, F&& f, Args&&... args) {
+  if (s == nullptr)
+    return f(std::forward<Args>(args)...);
+
+  using namespace std::chrono;
+  auto allocs = thread_allocs();
+  auto start = steady_clock::now();
+
+  auto res = f(std::forward<Args>(args)...);
+
+  auto ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+  bool fired;
+  if constexpr (requires { res.exists(); })
+    fired = res.exists();
+  else
+    fired = !res.empty();
+
+  s->add(ns, fired, thread_allocs() - allocs);
+  return res;
+}
@@ -4,6 +4,7 @@
 #include "util/times.h"
 
 #include <cmath>
+#include <utility>
 #include <vector>
 
 struct IndicatorsTrends;
@@ -24,6 +25,24 @@ struct Score {
 
 struct Stats;
 struct Signal;
+struct SignalConfig;
+
+// The reasons and hints at a candle with the importance their backtests gave
+// them. Everything after this, weights, rating and score, only depends on
+// the SignalConfig, so it can be re-rated under another config for free.
+struct Evidence {
+  std::vector<std::pair<Reason, double>> reasons;
+  std::vector<std::pair<Hint, double>> hints;
+
+  Evidence() = default;
+  Evidence(const Indicators& ind, int idx);
+
+  // entry and exit weights
+  std::pair<double, double> weigh(const SignalConfig& cfg) const;
+  Rating rate(double entry_w, double exit_w, const SignalConfig& cfg) const;
+};
+
+Score gen_score(double entry_w, double exit_w, const SignalConfig& cfg);
 
 struct Forecast {
   double exp_pnl = 0.0;
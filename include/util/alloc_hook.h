@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+// Heap allocations made by the calling thread so far, counted by the
+// replacement operator new in alloc_hook.cpp. The difference around a piece
+// of work is what it allocated.
+uint64_t thread_allocs() noexcept;
+uint64_t thread_alloc_bytes() noexcept;
+
+// sets the calling thread's counts back to earlier values
+void rewind_thread_allocs(uint64_t count, uint64_t bytes) noexcept;
+
+// Allocations of every thread within one tracing stage
+struct AllocStage {
+  std::atomic<const char*> name = nullptr;
+  std::atomic<uint64_t> count = 0;
+  std::atomic<uint64_t> bytes = 0;
+
+  // totals at the previous report
+  uint64_t last_count = 0;
+  uint64_t last_bytes = 0;
+};
+
+// The stage operator new charges on this thread, set by the innermost Span
+// while accounting is on and null otherwise
+inline thread_local AllocStage* alloc_stage = nullptr;
+
+// Allocations made on the thread while one is alive count against neither
+// the thread nor a stage, for the tracer's and the accounting's own
+// bookkeeping
+class UncountedAllocs {
+  AllocStage* stage;
+  uint64_t count;
+  uint64_t bytes;
+
+ public:
+  UncountedAllocs() noexcept
+      : stage{std::exchange(alloc_stage, nullptr)},
+        count{thread_allocs()},
+        bytes{thread_alloc_bytes()} {}
+
+  ~UncountedAllocs() noexcept {
+    rewind_thread_allocs(count, bytes);
+    alloc_stage = stage;
+  }
+
+  UncountedAllocs(const UncountedAllocs&) = delete;
+  UncountedAllocs& operator=(const UncountedAllocs&) = delete;
+};
+
+// Opt-in attribution of allocations to the active Span. Stages are claimed
+// by name on first use and never released.
+class AllocStats {
+  static constexpr size_t MAX_STAGES = 64;
+
+  std::atomic<bool> on = false;
+  std::array<AllocStage, MAX_STAGES> stages{};
+
+  std::mutex mtx;  // serializes reports
+
+ public:
+  void enable(bool en) { on.store(en, std::memory_order_relaxed); }
+  bool enabled() const { return on.load(std::memory_order_relaxed); }
+
+  // the stage named `name`, null once every slot is taken
+  AllocStage* stage(const char* name) noexcept;
+
+  // logs and exports what each stage allocated since the last report
+  void report();
+};
+
+inline AllocStats alloc_stats;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Per-thread monotonic arena for the temporaries of one ticker recompute.
+// Allocating is a pointer bump into a buffer kept for the life of the
+// thread, and everything is dropped at once when the outermost ScratchScope
+// on the thread closes. Outside a scope scratch() is the plain heap, so the
+// same code also runs in backtests and tools.
+struct ScratchArena {
+  static constexpr size_t SIZE = 64 * 1024;
+
+  std::unique_ptr<std::byte[]> buf{new std::byte[SIZE]};
+  std::pmr::monotonic_buffer_resource res{buf.get(), SIZE,
+                                          std::pmr::new_delete_resource()};
+};
+
+inline thread_local int scratch_depth = 0;
+
+// created on first use, so threads that never recompute don't pay for it
+inline ScratchArena& scratch_arena() {
+  thread_local ScratchArena arena;
+  return arena;
+}
+
+// Only for locals that die before the scope closes, never for members of
+// anything that is kept
+inline std::pmr::memory_resource* scratch() {
+  if (scratch_depth == 0)
+    return std::pmr::new_delete_resource();
+  return &scratch_arena().res;
+}
+
+class ScratchScope {
+ public:
+  ScratchScope() noexcept { scratch_depth++; }
+
+  // release() rewinds to the start of the thread's buffer, chunks taken from
+  // the heap on overflow are freed
+  ~ScratchScope() noexcept {
+    if (--scratch_depth == 0)
+      scratch_arena().res.release();
+  }
+
+  ScratchScope(const ScratchScope&) = delete;
+  ScratchScope& operator=(const ScratchScope&) = delete;
+};
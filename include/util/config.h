@@ -75,6 +75,7 @@ struct RiskConfig {  // Rename from PositionSizingConfig
 
   // Other
   int earnings_buffer_days = 5;
+  int stop_monitor_secs = 45;  // fastest price poll for open positions
 
   double capital_usd() const { return capital * to_usd_rate; }
   double max_risk_amount() const {
@@ -175,6 +176,10 @@ struct APIConfig {
 
   std::vector<std::string> td_api_keys = {};
 
+  // base urls, overridable to point at a local stand-in
+  std::string td_url = "https://api.twelvedata.com";
+  std::string tg_url = "https://api.telegram.org";
+
   std::string tg_token;
   std::string tg_chat_id;
   std::string tg_user;
@@ -194,10 +199,22 @@ struct Config {
   bool replay_en = false;
   bool replay_paused = false;
   bool replay_clear = false;
+  bool headless = false;  // replay at full speed, render only at checkpoints
+  size_t checkpoint = 0;  // steps between headless renders, 0 = only the last
+
+  bool simulate_en = false;  // walk-forward simulation over the replay data
+  size_t warmup = 1000;      // candles a simulated ticker starts with
+  std::string sweep_spec;    // search space of a parameter sweep
+
+  bool trace_en = false;  // chrome trace of every update cycle in logs/trace
+  std::string metrics_addr;  // prometheus port or unix socket, empty = off
+  bool profile_rules = false;  // per-rule cost and hit rate on rules.html
+  bool alloc_report = false;  // heap allocations per trace stage, per update
 
   double speed = 0.0;
 
   size_t n_concurrency = 1;
+  size_t n_fetch = 4;
 
   APIConfig api_config;
   IndicatorsConfig ind_config;
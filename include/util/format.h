@@ -85,6 +85,15 @@ constexpr std::string tagged(const T& t, Tags... tags) {
   return str;
 }
 
+// tagged on html, the bare value for targets without markup
+template <FormatTarget target, typename T, typename... Tags>
+constexpr std::string tagged_as(const T& t, Tags... tags) {
+  if constexpr (target == FormatTarget::HTML)
+    return tagged(t, tags...);
+  else
+    return to_str(t);
+}
+
 struct fmt_string : public std::string {
   using std::string::operator=;
 
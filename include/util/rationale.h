@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Sections of a rationale, laid out by whoever renders it
+enum class Part : uint8_t {
+  Reason,
+  Detail,
+  Adjust,
+  Context,
+};
+
+// A decision trail kept as codes with numeric arguments instead of text.
+// Recording a step is a push_back; the html or telegram text is only built
+// by to_str<target>(rationale, owner) when a page or message shows it.
+template <typename Code>
+struct Rationale {
+  struct Note {
+    Code code;
+    Part part;
+    std::array<double, 3> args;
+
+    double operator[](size_t k) const { return args[k]; }
+    int i(size_t k) const { return static_cast<int>(args[k]); }
+    template <typename E>
+    E as(size_t k) const {
+      return static_cast<E>(static_cast<int>(args[k]));
+    }
+  };
+
+  std::vector<Note> notes;
+
+  template <typename... Args>
+  void add(Part part, Code code, Args... args) {
+    static_assert(sizeof...(Args) <= 3);
+    notes.push_back({code, part, {static_cast<double>(args)...}});
+  }
+
+  template <typename... Args>
+  void add_front(Part part, Code code, Args... args) {
+    static_assert(sizeof...(Args) <= 3);
+    notes.insert(notes.begin(), {code, part, {static_cast<double>(args)...}});
+  }
+
+  bool empty() const { return notes.empty(); }
+
+  bool has(Code code) const {
+    for (auto& n : notes)
+      if (n.code == code)
+        return true;
+    return false;
+  }
+
+  bool has(Part part) const {
+    for (auto& n : notes)
+      if (n.part == part)
+        return true;
+    return false;
+  }
+
+  // the notes of one part rendered by `str` and joined by `sep`
+  template <typename F>
+  std::string join(Part part, std::string_view sep, F&& str) const {
+    std::string res;
+    bool first = true;
+    for (auto& n : notes) {
+      if (n.part != part)
+        continue;
+      if (!first)
+        res += sep;
+      res += str(n);
+      first = false;
+    }
+    return res;
+  }
+};
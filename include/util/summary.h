@@ -0,0 +1,18 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <format>
+#include <iostream>
+#include <string>
+
+// A line of an end-of-run summary, to the log and to stdout, as such runs
+// are usually watched from the terminal. `tag` goes in front, in brackets.
+template <typename... Args>
+inline void summary(const char* tag,
+                    std::format_string<Args...> fmt,
+                    Args&&... args) {
+  auto line = std::format(fmt, std::forward<Args>(args)...);
+  spdlog::info("[{}] {}", tag, line.c_str());
+  std::cout << "[" << tag << "] " << line << std::endl;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "util/times.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+class Counter {
+  std::atomic<uint64_t> n = 0;
+
+ public:
+  void inc(uint64_t by = 1) { n.fetch_add(by, std::memory_order_relaxed); }
+  uint64_t value() const { return n.load(std::memory_order_relaxed); }
+};
+
+class Gauge {
+  std::atomic<double> v = 0.0;
+
+ public:
+  void set(double x) { v.store(x, std::memory_order_relaxed); }
+  void add(double x) { v.fetch_add(x, std::memory_order_relaxed); }
+  double value() const { return v.load(std::memory_order_relaxed); }
+};
+
+// Latencies in ms over log-linear buckets, a few linear sub-buckets per power
+// of two as in an hdr histogram: under 25% relative error from 62.5us to
+// over four minutes, at a fixed size and without locking.
+class Histogram {
+ public:
+  static constexpr int MIN_EXP = -4;
+  static constexpr int N_OCTAVES = 22;
+  static constexpr int N_SUB = 4;
+  static constexpr size_t N_BUCKETS = N_OCTAVES * N_SUB + 1;  // last is +Inf
+
+ private:
+  std::array<std::atomic<uint64_t>, N_BUCKETS> counts{};
+  std::atomic<uint64_t> n = 0;
+  std::atomic<double> sum = 0.0;
+
+ public:
+  static double upper_bound(size_t i);
+  static size_t bucket_of(double ms);
+
+  void observe(double ms);
+
+  uint64_t count() const { return n.load(std::memory_order_relaxed); }
+  double total() const { return sum.load(std::memory_order_relaxed); }
+  uint64_t bucket(size_t i) const {
+    return counts[i].load(std::memory_order_relaxed);
+  }
+};
+
+// times the scope into a histogram
+class Timed {
+  Histogram& h;
+  Timer timer;
+
+ public:
+  explicit Timed(Histogram& h) : h{h} {}
+  ~Timed() { h.observe(timer.diff_ms()); }
+
+  Timed(const Timed&) = delete;
+  Timed& operator=(const Timed&) = delete;
+};
+
+// In-process metrics, rendered in the prometheus text format. Lookups take a
+// lock, so hot paths keep the returned reference, which stays valid for the
+// life of the process.
+class Telemetry {
+  template <typename T>
+  struct Family {
+    std::string help;
+    std::map<std::string, std::unique_ptr<T>> series;  // by rendered labels
+  };
+
+  std::mutex mtx;
+  std::map<std::string, Family<Counter>> counters;
+  std::map<std::string, Family<Gauge>> gauges;
+  std::map<std::string, Family<Histogram>> histograms;
+
+  template <typename T>
+  T& get(std::map<std::string, Family<T>>& families,
+         const std::string& name,
+         const std::string& help,
+         const Labels& labels);
+
+ public:
+  Counter& counter(const std::string& name,
+                   const std::string& help,
+                   const Labels& labels = {});
+  Gauge& gauge(const std::string& name,
+               const std::string& help,
+               const Labels& labels = {});
+  Histogram& histogram(const std::string& name,
+                       const std::string& help,
+                       const Labels& labels = {});
+
+  std::string expose();
+};
+
+inline Telemetry telemetry;
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 
 using Clock = std::chrono::steady_clock;
 using TimePoint = Clock::time_point;
@@ -33,11 +35,36 @@ inline LocalTimePoint date_to_local(std::string_view datetime,
 std::string datetime_to_string(LocalTimePoint tp);
 
 SysTimePoint now_utc_time(std::string_view timezone = ny_tz);
-LocalTimePoint now_ny_time();
+
+// "Now" for everything that reasons about the market: days held, days until
+// an event, market hours. Live it's the wall clock. A replay pins it to the
+// candle being replayed, so a step sees the same time it would have seen
+// live and runs as fast as it can be computed.
+class MarketClock {
+  static constexpr int64_t LIVE = INT64_MIN;
+  std::atomic<int64_t> pinned{LIVE};  // seconds of the local ny time
+
+ public:
+  LocalTimePoint now() const;
+
+  bool simulated() const { return pinned.load() != LIVE; }
+  void set(LocalTimePoint tp) { pinned = tp.time_since_epoch().count(); }
+  void live() { pinned = LIVE; }
+};
+
+inline MarketClock market_clock;
+
+inline LocalTimePoint now_ny_time() {
+  return market_clock.now();
+}
+
+// for file names and logs, which are about when things actually happened
+LocalTimePoint wall_ny_time();
 
 std::string closest_nyse_aligned_time(const std::string& ny_time_str);
 
 std::pair<bool, minutes> market_status(minutes update_interval);
+bool is_market_hours(LocalTimePoint tp);
 
 struct Timer {
   TimePoint start;
@@ -51,6 +78,25 @@ struct Timer {
   }
 };
 
+// Point in time after which work is no longer worth starting. The default
+// never expires.
+struct Deadline {
+  TimePoint at = TimePoint::max();
+
+  Deadline() = default;
+  explicit Deadline(TimePoint at) : at{at} {}
+
+  bool expired() const { return Clock::now() >= at; }
+
+  milliseconds remaining() const {
+    if (at == TimePoint::max())
+      return milliseconds::max();
+    auto now = Clock::now();
+    return now >= at ? milliseconds{0}
+                     : std::chrono::duration_cast<milliseconds>(at - now);
+  }
+};
+
 bool first_candle_in_interval(minutes interval, LocalTimePoint tp);
 bool last_candle_in_interval(minutes interval, LocalTimePoint tp);
 
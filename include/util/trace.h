@@ -0,0 +1,95 @@
+#pragma once
+
+#include "util/alloc_hook.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Scoped spans of the hot path, dumped as chrome trace-event json that
+// perfetto and chrome://tracing open. Each thread records into its own
+// buffer; while tracing is off a span costs one relaxed load.
+class Tracer {
+  struct Event {
+    const char* name;
+    std::string arg;  // symbol, empty if none
+    int64_t start_ns;
+    int64_t dur_ns;
+  };
+
+  struct Buffer {
+    std::mutex mtx;  // only contended while dumping
+    std::vector<Event> events;
+    uint32_t tid = 0;
+  };
+
+  std::atomic<bool> on = false;
+
+  std::mutex mtx;
+  std::vector<std::shared_ptr<Buffer>> buffers;
+  uint32_t next_tid = 1;
+  size_t n_dumps = 0;
+
+  Buffer& local();
+
+ public:
+  void enable(bool en) { on.store(en, std::memory_order_relaxed); }
+  bool enabled() const { return on.load(std::memory_order_relaxed); }
+
+  static int64_t now_ns();
+  void record(const char* name,
+              std::string&& arg,
+              int64_t start_ns,
+              int64_t dur_ns);
+
+  // writes the spans recorded since the last dump to {dir}/trace_{n}.json
+  // and drops them
+  bool dump(const std::string& dir);
+};
+
+inline Tracer tracer;
+
+// `name` has to outlive the tracer, `arg` is copied only while tracing.
+// While allocation accounting is on, the span's stage is charged with the
+// allocations made inside it and not in a nested span, but not with the
+// tracer's own.
+class Span {
+  const char* name;
+  std::string arg;
+  int64_t start_ns = 0;
+
+  AllocStage* outer = nullptr;
+  bool charged = false;
+
+ public:
+  explicit Span(const char* name, std::string_view arg = {}) noexcept
+      : name{name} {
+    if (alloc_stats.enabled()) {
+      outer = std::exchange(alloc_stage, alloc_stats.stage(name));
+      charged = true;
+    }
+    if (!tracer.enabled())
+      return;
+    {
+      UncountedAllocs _;
+      this->arg = arg;
+    }
+    start_ns = Tracer::now_ns();
+  }
+
+  ~Span() noexcept {
+    if (start_ns != 0)
+      tracer.record(name, std::move(arg), start_ns,
+                    Tracer::now_ns() - start_ns);
+    if (charged)
+      alloc_stage = outer;
+  }
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <utility>
+
+// The last `depth` undo entries, each tagged with the step it was taken
+// before. Older entries fall off the front.
+template <typename T>
+class UndoLog {
+  std::deque<std::pair<size_t, T>> entries;
+  size_t depth;
+
+ public:
+  explicit UndoLog(size_t depth = 64) noexcept : depth{depth} {}
+
+  void push(size_t step, T t) {
+    if (depth == 0)
+      return;
+    entries.emplace_back(step, std::move(t));
+    if (entries.size() > depth)
+      entries.pop_front();
+  }
+
+  // the entry saved before `step`, if that step changed anything
+  std::optional<T> pop(size_t step) {
+    if (entries.empty() || entries.back().first != step)
+      return std::nullopt;
+    auto t = std::move(entries.back().second);
+    entries.pop_back();
+    return t;
+  }
+
+  void clear() { entries.clear(); }
+};
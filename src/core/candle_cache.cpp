@@ -0,0 +1,252 @@
+#include "core/candle_cache.h"
+#include "mt/api.h"
+
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+inline constexpr auto cache_dir = "private/candles";
+
+CandleCache::CandleCache(const std::string& symbol, minutes timeframe) noexcept
+    : path{std::format("{}/{}_{}m.bin",  //
+                       cache_dir, symbol, timeframe.count())},
+      timeframe{timeframe} {}
+
+CandleCache::Record CandleCache::to_record(const Candle& c) {
+  return {
+      .time = c.time().time_since_epoch().count(),
+      .open = c.open,
+      .high = c.high,
+      .low = c.low,
+      .close = c.close,
+      .volume = c.volume,
+  };
+}
+
+Candle CandleCache::to_candle(const Record& r) {
+  return {
+      .datetime = LocalTimePoint{seconds{r.time}},
+      .open = r.open,
+      .high = r.high,
+      .low = r.low,
+      .close = r.close,
+      .volume = static_cast<int>(r.volume),
+  };
+}
+
+// true if the session had candles between `prev` and `next`. a day's first
+// candle may follow any earlier day, so weekends and holidays aren't gaps
+inline bool is_gap(LocalTimePoint prev,
+                   LocalTimePoint next,
+                   minutes timeframe) {
+  if (timeframe >= D_1)
+    return false;
+
+  auto day = floor<days>(next);
+  if (floor<days>(prev) == day)
+    return next - prev > timeframe;
+  return next - day > hours{9} + minutes{30};
+}
+
+inline bool read_at(int fd, void* buf, size_t n, off_t off) {
+  return ::pread(fd, buf, n, off) == static_cast<ssize_t>(n);
+}
+
+inline bool write_at(int fd, const void* buf, size_t n, off_t off) {
+  return ::pwrite(fd, buf, n, off) == static_cast<ssize_t>(n);
+}
+
+TimeSeriesRes CandleCache::read(size_t max_n) const {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return {};
+
+  struct stat st;
+  if (::fstat(fd, &st) == -1 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return {};
+  }
+
+  auto sz = static_cast<size_t>(st.st_size);
+  auto* p = ::mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) {
+    spdlog::error("[cache] mmap failed for {}", path.c_str());
+    return {};
+  }
+
+  TimeSeriesRes res;
+  auto* base = static_cast<const char*>(p);
+
+  Header header, expected;
+  std::memcpy(&header, base, sizeof(Header));
+  if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+      header.version != expected.version) {
+    spdlog::error("[cache] {} has an unknown format", path.c_str());
+    ::munmap(p, sz);
+    return {};
+  }
+
+  // a partial record left by an interrupted write is ignored
+  auto n = (sz - sizeof(Header)) / sizeof(Record);
+  auto from = n > max_n ? n - max_n : 0;
+  res.reserve(n - from);
+
+  Record r;
+  for (auto i = from; i < n; i++) {
+    std::memcpy(&r, base + sizeof(Header) + i * sizeof(Record), sizeof(r));
+    res.push_back(to_candle(r));
+  }
+
+  ::munmap(p, sz);
+  return res;
+}
+
+bool CandleCache::write(const TimeSeriesRes& candles) const {
+  std::error_code ec;
+  fs::create_directories(cache_dir, ec);
+
+  auto tmp = path + ".tmp";
+  {
+    std::ofstream ofs{tmp, std::ios::binary | std::ios::trunc};
+    Header header;
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (auto& c : candles) {
+      auto r = to_record(c);
+      ofs.write(reinterpret_cast<const char*>(&r), sizeof(r));
+    }
+    if (!ofs) {
+      spdlog::error("[cache] error writing {}", tmp.c_str());
+      return false;
+    }
+  }
+
+  fs::rename(tmp, path, ec);
+  if (ec) {
+    spdlog::error("[cache] error renaming {}: {}", tmp.c_str(),
+                  ec.message().c_str());
+    return false;
+  }
+  return true;
+}
+
+// rewrites the file with only the candles time_series reads back
+bool CandleCache::compact() const {
+  auto candles = read(MAX_OUTPUT_SIZE);
+  if (candles.empty())
+    return false;
+  return write(candles);
+}
+
+bool CandleCache::merge(const TimeSeriesRes& fresh) const {
+  if (fresh.empty())
+    return true;
+
+  int fd = ::open(path.c_str(), O_RDWR);
+  if (fd == -1)
+    return write(fresh);
+
+  struct stat st;
+  if (::fstat(fd, &st) == -1 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return write(fresh);
+  }
+
+  auto sz = static_cast<size_t>(st.st_size);
+  auto n = (sz - sizeof(Header)) / sizeof(Record);
+  auto at = [](size_t i) {
+    return static_cast<off_t>(sizeof(Header) + i * sizeof(Record));
+  };
+
+  // the overlap with fresh candles is a few records at the tail
+  auto pos = n;
+  Record r;
+  auto first = fresh.front().time().time_since_epoch().count();
+  while (pos > 0) {
+    if (!read_at(fd, &r, sizeof(r), at(pos - 1)) || r.time < first)
+      break;
+    pos--;
+  }
+
+  bool ok = true;
+  for (auto& c : fresh) {
+    auto rec = to_record(c);
+    ok &= write_at(fd, &rec, sizeof(rec), at(pos++));
+  }
+  ok &= ::ftruncate(fd, at(pos)) == 0;
+  ::close(fd);
+
+  if (!ok)
+    spdlog::error("[cache] error merging into {}", path.c_str());
+  else if (pos >= 2 * MAX_OUTPUT_SIZE)
+    ok = compact();
+  return ok;
+}
+
+bool CandleCache::put(const Candle& candle) const {
+  int fd = ::open(path.c_str(), O_RDWR);
+  if (fd == -1)
+    return false;
+
+  struct stat st;
+  if (::fstat(fd, &st) == -1 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return false;
+  }
+
+  auto sz = static_cast<size_t>(st.st_size);
+  auto n = (sz - sizeof(Header)) / sizeof(Record);
+  auto at = [](size_t i) {
+    return static_cast<off_t>(sizeof(Header) + i * sizeof(Record));
+  };
+
+  auto rec = to_record(candle);
+  auto pos = n;
+  if (n > 0) {
+    Record last;
+    if (!read_at(fd, &last, sizeof(last), at(n - 1))) {
+      ::close(fd);
+      return false;
+    }
+    if (last.time > rec.time) {
+      ::close(fd);
+      return true;
+    }
+    if (last.time == rec.time) {
+      pos = n - 1;
+    } else if (is_gap(to_candle(last).time(), candle.time(), timeframe)) {
+      // a shed cycle skipped candles, the delta fetch only looks past the
+      // last one so it would never fill them in
+      ::close(fd);
+      spdlog::warn("[cache] {} misses candles before {}, dropped",
+                   path.c_str(), std::format("{}", candle.time()).c_str());
+      std::error_code ec;
+      fs::remove(path, ec);
+      return false;
+    }
+  }
+
+  bool ok = write_at(fd, &rec, sizeof(rec), at(pos));
+  if (st.st_size > at(pos + 1))
+    ok &= ::ftruncate(fd, at(pos + 1)) == 0;
+  ::close(fd);
+
+  if (ok && pos + 1 >= 2 * MAX_OUTPUT_SIZE)
+    ok = compact();
+
+  if (!ok)
+    spdlog::error("[cache] error appending to {}", path.c_str());
+  return ok;
+}
@@ -71,6 +71,49 @@ void Config::read_args(int argc, char* argv[]) {
       .implicit_value(true)
       .help("Enable replaying mode");
 
+  program.add_argument("-H", "--headless")
+      .default_value(false)
+      .implicit_value(true)
+      .help("Replay as fast as possible without rendering, then report");
+
+  program.add_argument("--checkpoint")
+      .help("Render every n steps of a headless replay")
+      .default_value(size_t{0})
+      .scan<'d', size_t>();
+
+  program.add_argument("-S", "--simulate")
+      .default_value(false)
+      .implicit_value(true)
+      .help("Simulate trading over the replay data, then report");
+
+  program.add_argument("--warmup")
+      .help("Candles of history each simulated ticker starts with")
+      .default_value(size_t{1000})
+      .scan<'d', size_t>();
+
+  program.add_argument("--sweep")
+      .help("Sweep signal and risk parameters over the replay data")
+      .default_value(std::string{});
+
+  program.add_argument("--trace")
+      .default_value(false)
+      .implicit_value(true)
+      .help("Write a chrome trace of every update cycle to logs/trace");
+
+  program.add_argument("--metrics")
+      .help("Serve prometheus metrics on this local port or unix socket")
+      .default_value(std::string{});
+
+  program.add_argument("--profile-rules")
+      .default_value(false)
+      .implicit_value(true)
+      .help("Profile every reason, hint and filter rule into rules.html");
+
+  program.add_argument("--alloc-report")
+      .default_value(false)
+      .implicit_value(true)
+      .help("Log heap allocations and bytes per stage after every update");
+
   program.add_argument("-c", "--clear")
       .default_value(false)
       .implicit_value(true)
@@ -97,6 +140,11 @@ void Config::read_args(int argc, char* argv[]) {
       .default_value(def_nthreads)
       .scan<'d', size_t>();
 
+  program.add_argument("--nfetch")
+      .help("Max number of concurrent api fetches")
+      .default_value(size_t{4})
+      .scan<'d', size_t>();
+
   try {
     program.parse_args(argc, argv);
   } catch (const std::runtime_error& err) {
@@ -112,9 +160,21 @@ void Config::read_args(int argc, char* argv[]) {
   port = program.get<int>("--port");
   reload_port = RELOAD_PORT_DEFAULT + port - PORT_DEFAULT;
 
-  replay_en =
-      program.get<bool>("--replay") || program.get<bool>("--replay-paused");
-  replay_paused = program.get<bool>("--replay-paused");
+  headless = program.get<bool>("--headless");
+  checkpoint = program.get<size_t>("--checkpoint");
+
+  simulate_en = program.get<bool>("--simulate");
+  warmup = program.get<size_t>("--warmup");
+  sweep_spec = program.get<std::string>("--sweep");
+  trace_en = program.get<bool>("--trace");
+  metrics_addr = program.get<std::string>("--metrics");
+  profile_rules = program.get<bool>("--profile-rules");
+  alloc_report = program.get<bool>("--alloc-report");
+
+  replay_en = program.get<bool>("--replay") ||
+              program.get<bool>("--replay-paused") || headless;
+  replay_paused = program.get<bool>("--replay-paused") && !headless;
 
   n_concurrency = program.get<size_t>("--nthreads");
+  n_fetch = program.get<size_t>("--nfetch");
 }
@@ -0,0 +1,58 @@
+#include "core/page_cache.h"
+#include "util/telemetry.h"
+
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <functional>
+#include <string_view>
+
+void FragmentCache::count(bool rendered) {
+  static auto& n_rendered = telemetry.counter(
+      "fin_page_fragments_total", "Page fragments by cache outcome",
+      {{"result", "rendered"}});
+  static auto& n_cached = telemetry.counter(
+      "fin_page_fragments_total", "Page fragments by cache outcome",
+      {{"result", "cached"}});
+  (rendered ? n_rendered : n_cached).inc();
+}
+
+bool write_if_changed(const std::string& path, const std::string& content) {
+  static auto& n_written = telemetry.counter(
+      "fin_page_files_total", "Page files by write outcome",
+      {{"result", "written"}});
+  static auto& n_unchanged = telemetry.counter(
+      "fin_page_files_total", "Page files by write outcome",
+      {{"result", "unchanged"}});
+
+  static std::mutex mtx;
+  static std::map<std::string, size_t, std::less<>> hashes;
+
+  auto h = std::hash<std::string_view>{}(content);
+  {
+    std::lock_guard _{mtx};
+    auto it = hashes.find(path);
+    if (it != hashes.end() && it->second == h) {
+      n_unchanged.inc();
+      return true;
+    }
+  }
+
+  std::ofstream f{path};
+  f << content;
+  f.flush();
+  f.close();
+  if (!f) {
+    spdlog::error("[page] error writing {}", path.c_str());
+    return false;
+  }
+
+  // only a write that made it to disk is remembered, a failed one is tried
+  // again with the next render
+  {
+    std::lock_guard _{mtx};
+    hashes.insert_or_assign(path, h);
+  }
+  n_written.inc();
+  return true;
+}
@@ -1,16 +1,29 @@
+#include "core/candle_cache.h"
 #include "core/portfolio.h"
 #include "mt/sleeper.h"
 #include "mt/thread_pool.h"
 #include "util/config.h"
 #include "util/format.h"
 #include "util/raw_mode.h"
+#include "util/telemetry.h"
 #include "util/times.h"
+#include "util/trace.h"
 
 #include <spdlog/spdlog.h>
+#include <atomic>
 #include <iostream>
 
 #include <thread>
 
+inline constexpr auto trace_dir = "logs/trace";
+
+// what update latency is alerted against
+inline Gauge& update_interval_gauge() {
+  static auto& g = telemetry.gauge("fin_update_interval_ms",
+                                   "Time between update cycles");
+  return g;
+}
+
 Portfolio::Portfolio() noexcept
     : Endpoint{PORTFOLIO_ID},
       symbols{},
@@ -34,8 +47,13 @@ Portfolio::Portfolio() noexcept
       return false;
 
     auto symbol = si.symbol;
+    Span _{"init", symbol};
 
-    auto candles = time_series(symbol, H_1);
+    TimeSeriesRes candles;
+    {
+      Span _{"fetch", symbol};
+      candles = time_series(symbol, H_1);
+    }
     if (candles.empty()) {
       spdlog::error("[init] ({}) no candles", symbol.c_str());
       return true;
@@ -49,6 +67,7 @@ Portfolio::Portfolio() noexcept
                   H_1,
                   positions.get_position(symbol)};
 
+    publish_levels(symbol, ticker);
     {
       auto _ = writer_lock();
       tickers.try_emplace(symbol, std::move(ticker));
@@ -62,87 +81,319 @@ Portfolio::Portfolio() noexcept
 
   Timer timer;
   {
-    thread_pool<SymbolInfo> pool{config.n_concurrency, func, symbols.arr};
+    thread_pool<SymbolInfo> pool{config.n_concurrency, func,
+                                 by_priority(symbols, positions)};
   }
   auto ms = timer.diff_ms();
+  if (config.trace_en)
+    tracer.dump(trace_dir);
+  if (config.alloc_report)
+    alloc_stats.report();
 
   if (sleeper.should_shutdown() || tickers.empty()) {
     sleeper.request_shutdown();
     return;
   }
 
+  plan = plan_refresh();
+  update_interval = plan.tick;
+  monitor_interval = plan.monitor;
+  update_interval_gauge().set(
+      std::chrono::duration<double, std::milli>(update_interval).count());
+
   last_updated = now_ny_time();
   write_page();
 
   server = std::thread{[this] { iter(); }};
+  if (!config.replay_en)
+    monitor = std::thread{[this] { monitor_stops(); }};
 
   spdlog::info("[init] at {} took {:.2f}ms",
                std::format("{}", last_updated).c_str(), ms);
 }
 
+RefreshPlan Portfolio::plan_refresh() const {
+  auto& sig_config = config.sig_config;
+
+  // 1 when the score sits on a threshold, 0 when it's a full threshold away
+  auto closeness = [](double w, double threshold) {
+    return std::max(0.0, 1.0 - std::abs(w - threshold) / threshold);
+  };
+
+  std::vector<RefreshDemand> demands;
+  {
+    auto _ = reader_lock();
+    for (auto& [symbol, ticker] : tickers) {
+      auto& m = ticker.metrics;
+      auto& score = m.ind_1h.signal.score;
+      demands.emplace_back(
+          symbol, m.has_position(), m.ind_1d.atr_pct(-1),
+          std::max(closeness(score.entry, sig_config.entry_threshold),
+                   closeness(score.exit, sig_config.exit_threshold)));
+    }
+  }
+
+  return {std::move(demands), td.daily_quota(), td.minute_quota(),
+          seconds{config.risk_config.stop_monitor_secs}};
+}
+
+struct CandleUpdate {
+  std::string symbol;
+  Candle prev;
+  Candle candle;
+  Tier tier;
+};
+
 void Portfolio::add_candle() {
+  // a replay's daily SPY series runs out long before the hourly ones, SPY
+  // then holds at its last bar and the step still moves every cursor on
   auto [_, spy_next] = real_time("SPY", D_1);
-  if (spy_next.time() == LocalTimePoint{}) {
+  if (spy_next.time() != LocalTimePoint{}) {
+    if (config.replay_en)
+      spy_undo.push(rp.tick(), spy.undo_point());
+    spy.push_back(spy_next);
+    if (!config.replay_en)
+      CandleCache{"SPY", D_1}.put(spy_next);
+  } else if (!config.replay_en) {
     spdlog::error("[push_back] (SPY) invalid candle {}",
                   to_str(spy_next).c_str());
     return;
   }
-  spy.push_back(spy_next);
-
-  auto func = [&](SymbolInfo&& si) {
-    if (sleeper.should_shutdown())
-      return false;
-
-    auto& symbol = si.symbol;
 
-    auto it = tickers.find(symbol);
-    if (it == tickers.end())
-      return true;
+  // fetch -> compute -> publish: fetches are bounded by config.n_fetch, each
+  // candle is recomputed as soon as it arrives, and the ticker's plot and
+  // page are written right after. the pools are torn down in reverse order,
+  // so every stage drains before the next one stops.
 
-    auto [_, next] = real_time(symbol, H_1);
-    if (next.time() == LocalTimePoint{}) {
-      spdlog::error("[push_back] ({}) invalid candle: {}", symbol.c_str(),
-                    to_str(next).c_str());
-      return true;
-    }
+  // a headless replay only renders at checkpoints
+  auto step = stats.n_steps() + 1;
+  bool render = !config.headless ||
+                (config.checkpoint > 0 && step % config.checkpoint == 0);
 
-    it->second.push_back(next, positions.get_position(symbol));
+  auto publish_f = [this](std::string&& symbol) {
+    Span _{"publish", symbol};
+    Timer t;
     write_plot_data(symbol);
-
+    {
+      auto _ = reader_lock();
+      if (auto it = tickers.find(symbol); it != tickers.end())
+        write_ticker(it->second);
+    }
+    stats.add(Stage::Publish, t.diff_ms());
     return true;
   };
 
+  // held names and tier 1 are fetched first, and when the daily quota can't
+  // cover every symbol the lowest tiers are the ones left out
+  auto budget = config.replay_en ? SIZE_MAX : td.remaining_calls();
+  auto queue = by_priority(symbols, positions, budget);
+
+  // only the tickers whose cadence lands on this tick are refreshed
+  if (!config.replay_en) {
+    auto now = now_ny_time();
+    std::erase_if(queue, [&](auto& si) { return !plan.due(si.symbol, now); });
+  }
+
+  TierLatency latency;
+
+  // the cycle has to finish before the next tick. once past the deadline,
+  // everything but held names is shed and picked up by the next cycle.
+  auto deadline = config.replay_en
+                      ? Deadline{}
+                      : Deadline{Clock::now() + update_interval * 9 / 10};
+  std::atomic<size_t> n_shed = 0, n_superseded = 0;
+
   Timer timer;
   {
-    thread_pool<SymbolInfo> pool{config.n_concurrency, func, symbols.arr};
+    thread_pool<std::string> publish{1, publish_f, {}};
+
+    auto compute_f = [&](CandleUpdate&& upd) {
+      if (sleeper.should_shutdown())
+        return true;
+
+      auto it = tickers.find(upd.symbol);
+      if (it == tickers.end())
+        return true;
+
+      Span _{"compute", upd.symbol};
+      Timer t;
+      auto& ticker = it->second;
+      auto last = ticker.metrics.candles.back();
+
+      // nothing newer than what the ticker already has
+      if (upd.candle.time() < last.time() || upd.candle == last) {
+        n_superseded++;
+        return true;
+      }
+
+      // the previous candle closed after the last refresh, or its cycle was
+      // shed; push it first so no candle goes missing
+      auto pos = positions.get_position(upd.symbol);
+      bool push_prev = upd.prev.time() >= last.time() && upd.prev != last &&
+                       upd.prev.time() < upd.candle.time();
+
+      // a replay step can be taken back without recomputing anything
+      if (config.replay_en)
+        ticker.save_undo(rp.tick());
+
+      if (push_prev)
+        ticker.push_back(upd.prev, pos);
+
+      ticker.push_back(upd.candle, pos);
+      publish_levels(upd.symbol, ticker);
+
+      if (!config.replay_en) {
+        CandleCache cache{upd.symbol, H_1};
+        if (push_prev)
+          cache.put(upd.prev);
+        cache.put(upd.candle);
+      }
+      latency.add(upd.tier, timer.diff_ms());
+      stats.add(Stage::Compute, t.diff_ms());
+      stats.add_candles(push_prev ? 2 : 1);
+
+      if (render)
+        publish.emplace(std::move(upd.symbol));
+      return true;
+    };
+
+    thread_pool<CandleUpdate> compute{config.n_concurrency, compute_f, {},
+                                      2 * config.n_concurrency};
+
+    // one request per batch; a batch holding a position ignores the deadline
+    auto fetch_f = [&](std::vector<SymbolInfo>&& batch) {
+      if (sleeper.should_shutdown())
+        return false;
+
+      std::vector<std::pair<std::string, Tier>> wanted;
+      std::vector<std::string> symbols;
+      bool held = false;
+      for (auto& si : batch) {
+        if (!tickers.contains(si.symbol))
+          continue;
+
+        auto tier = tier_of(si, positions);
+        if (tier != Tier::Held && deadline.expired()) {
+          n_shed++;
+          continue;
+        }
+
+        held |= tier == Tier::Held;
+        symbols.push_back(si.symbol);
+        wanted.emplace_back(std::move(si.symbol), tier);
+      }
+
+      if (symbols.empty())
+        return true;
+
+      RealTimeBatch res;
+      {
+        Span _{"fetch"};
+        Timer t;
+        res = real_time(symbols, H_1, held ? Deadline{} : deadline);
+        stats.add(Stage::Fetch, t.diff_ms());
+      }
+
+      for (auto& [symbol, tier] : wanted) {
+        auto it = res.find(symbol);
+        if (it == res.end() || it->second.second.time() == LocalTimePoint{}) {
+          spdlog::error("[push_back] ({}) no candle", symbol.c_str());
+          continue;
+        }
+
+        auto& [prev, next] = it->second;
+        compute.emplace(std::move(symbol), prev, next, tier);
+      }
+      return true;
+    };
+
+    thread_pool<std::vector<SymbolInfo>> fetch{
+        config.n_fetch, fetch_f, in_batches(std::move(queue), MAX_CALLS_MIN)};
   }
   auto ms = timer.diff_ms();
+  if (!config.headless)
+    latency.report("update");
+
+  if (deadline.expired()) {
+    auto over = std::chrono::duration<double, std::milli>(Clock::now() -
+                                                          deadline.at);
+    spdlog::warn("[update] overran deadline by {:.0f}ms, {} shed",
+                 over.count(), n_shed.load());
+  }
+  if (n_superseded > 0)
+    spdlog::info("[update] {} tickers unchanged", n_superseded.load());
 
   if (sleeper.should_shutdown())
     return;
 
-  rp.roll_fwd();
-
+  // market time of this step, before a replay moves the clock on
   last_updated = now_ny_time();
-  write_page();
+  rp.roll_fwd();
 
-  send_to_broker(id, "update");
+  plan = plan_refresh();
+  update_interval = plan.tick;
+  monitor_interval = plan.monitor;
+  update_interval_gauge().set(
+      std::chrono::duration<double, std::milli>(update_interval).count());
+
+  // ticker pages were already written by the publish stage. the pages are
+  // waited for, so their time and spans belong to this step
+  if (render) {
+    Span _{"pages"};
+    Timer t;
+    write_index();
+    write_history();
+    write_positions();
+    write_rules();
+    await_pages();
+    stats.add(Stage::Pages, t.diff_ms());
+
+    send_to_broker(id, "update");
+  }
 
-  spdlog::info("[update] at {} took {:.2f}ms",
-               std::format("{}", last_updated).c_str(), ms);
+  stats.add_step(timer.diff_ms());
+  if (config.trace_en)
+    tracer.dump(trace_dir);
+  if (config.alloc_report)
+    alloc_stats.report();
+  spdlog::log(config.headless ? spdlog::level::debug : spdlog::level::info,
+              "[update] at {} took {:.2f}ms",
+              std::format("{}", last_updated).c_str(), ms);
 }
 
 void Portfolio::rollback() {
   if (!config.replay_en)
     return;
 
+  if (rp.tick() == 0)
+    return;
+
+  // restores the state saved before the last step, tickers it didn't touch
+  // are left as they are
+  auto step = rp.tick() - 1;
   {
     auto _ = writer_lock();
-    for (auto& [symbol, ticker] : tickers) {
-      ticker.rollback();
-      rp.rollback(symbol);
-      write_plot_data(symbol);
+    bool restored = false;
+    if (auto u = spy_undo.pop(step)) {
+      spy.undo(std::move(*u));
+      restored = true;
     }
+
+    for (auto& [symbol, ticker] : tickers)
+      if (ticker.undo(step)) {
+        publish_levels(symbol, ticker);
+        write_plot_data(symbol);
+        restored = true;
+      }
+
+    // older than the undo logs reach, stepping back would only move the
+    // cursor
+    if (!restored) {
+      spdlog::warn("[rollback] nothing saved for step {}", step);
+      return;
+    }
+
+    rp.roll_bwd();
   }
 
   if (!tickers.empty())
@@ -161,6 +412,7 @@ std::pair<const Position*, double> Portfolio::add_trade(const Trade& trade) {
     auto& ticker = tickers.at(trade.ticker);
     res.first = positions.get_position(trade.ticker);
     ticker.update_position(res.first);
+    publish_levels(trade.ticker, ticker);
   }
 
   write_plot_data(trade.ticker);
@@ -173,8 +425,10 @@ void Portfolio::update_trades() {
   {
     auto _ = writer_lock();
     positions.update_trades();
-    for (auto& [symbol, ticker] : tickers)
+    for (auto& [symbol, ticker] : tickers) {
       ticker.update_position(positions.get_position(symbol));
+      publish_levels(symbol, ticker);
+    }
   }
 
   for (auto& [symbol, _] : tickers)
@@ -203,6 +457,22 @@ void Portfolio::run() {
 }
 
 void Portfolio::run_replay() {
+  if (config.headless) {
+    Timer timer;
+    while (!sleeper.should_shutdown() && rp.has_data())
+      add_candle();
+    auto secs = timer.diff_s();
+
+    // the final state is always rendered
+    for (auto& [symbol, _] : tickers)
+      write_plot_data(symbol);
+    write_page();
+
+    stats.report(secs);
+    stop();
+    return;
+  }
+
   if (!config.replay_paused) {
     while (!sleeper.should_shutdown() && rp.has_data()) {
       if (!sleeper.sleep_for(config.update_interval())) {
@@ -236,10 +506,28 @@ void Portfolio::run_replay() {
   }
 }
 
+void Portfolio::write_async(std::function<void()> f) const {
+  std::lock_guard _{pages_mtx};
+  page_writers.emplace_back(std::move(f));
+}
+
+void Portfolio::await_pages() const {
+  std::vector<std::thread> writers;
+  {
+    std::lock_guard _{pages_mtx};
+    writers.swap(page_writers);
+  }
+  for (auto& t : writers)
+    t.join();
+}
+
 Portfolio::~Portfolio() noexcept {
   stop();
   sleeper.request_shutdown();
   if (server.joinable())
     server.join();
+  if (monitor.joinable())
+    monitor.join();
+  await_pages();
   std::cout << "[exit] portfolio" << std::endl;
 }
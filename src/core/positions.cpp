@@ -156,6 +156,17 @@ OpenPositions::OpenPositions() {
   update_trades();
 }
 
+OpenPositions::OpenPositions(Trades trades)
+    : trades_by_ticker{std::move(trades)} {
+  for (auto& [ticker, ts] : trades_by_ticker) {
+    auto [pos, pnl] = net_position(ts);
+    if (pos.qty > eps * 8)
+      positions[ticker] = pos;
+    else
+      total_pnl += pnl;
+  }
+}
+
 double OpenPositions::add_trade(const Trade& trade) {
   auto& symbol = trade.ticker;
   trades_by_ticker[symbol].emplace_back(trade);
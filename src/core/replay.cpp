@@ -5,13 +5,11 @@
 
 #include <cpr/cpr.h>
 #include <spdlog/spdlog.h>
+#include <algorithm>
 #include <filesystem>
 
 namespace fs = std::filesystem;
 
-void write_candles(const std::string& filename, const CandleStore& data);
-CandleStore read_candles(const std::string& filename);
-
 Replay::Replay(TD& td, const Symbols& symbols) noexcept
     : td{td},
       calls_per_hour{static_cast<size_t>(H_1 / td.interval)}  //
@@ -19,18 +17,28 @@ Replay::Replay(TD& td, const Symbols& symbols) noexcept
   if (!config.replay_en)
     return;
 
-  auto candles_fname = "private/replay_candles.bin";
+  auto open_store = [&] {
+    store = ReplayStore{replay_fname};
+    for (auto& [symbol, view] : store.all())
+      idx[symbol] = view.start;
+    sync_clock();
+    return !store.empty();
+  };
 
-  if (!config.replay_clear && fs::exists(candles_fname)) {
-    candles_by_sym = read_candles(candles_fname);
-    if (candles_by_sym.empty())
-      spdlog::error("[replay] error reading from {}", candles_fname);
-    else
-      spdlog::info("[replay] read from file");
-    return;
+  // a file that can't be read, an older format among them, is refetched and
+  // replaced like a cleared one
+  if (!config.replay_clear && fs::exists(replay_fname)) {
+    if (open_store()) {
+      spdlog::info("[replay] mapped {}", replay_fname);
+      return;
+    }
+    spdlog::warn("[replay] can't read {}, rebuilding", replay_fname);
+    store = ReplayStore{};
+    idx.clear();
   }
 
   std::mutex mtx;
+  std::unordered_map<std::string, ReplaySeries> series;
 
   auto func = [&, this](SymbolInfo&& si, minutes interval = H_1) {
     if (sleeper.should_shutdown())
@@ -45,14 +53,14 @@ Replay::Replay(TD& td, const Symbols& symbols) noexcept
     }
 
     auto date = candles.back().day();
-    auto idx = candles.size() - 1;
-    while (candles[idx].day() == date)
-      idx--;
-    idx++;
+    auto start = candles.size() - 1;
+    while (candles[start].day() == date)
+      start--;
+    start++;
 
     {
       std::lock_guard _{mtx};
-      candles_by_sym.try_emplace(symbol, std::move(candles), idx);
+      series.try_emplace(symbol, std::move(candles), start);
     }
 
     spdlog::info("[replay] fetched ({})", symbol.c_str());
@@ -65,62 +73,94 @@ Replay::Replay(TD& td, const Symbols& symbols) noexcept
     func(SymbolInfo{symbols.spy}, D_1);
   }
 
-  write_candles(candles_fname, candles_by_sym);
+  if (!ReplayStore::write(replay_fname, series) || !open_store())
+    spdlog::error("[replay] error writing {}", replay_fname);
   spdlog::info("[replay] constructed with intervals {}", calls_per_hour);
 }
 
+const CandleView* Replay::view(const std::string& symbol) const {
+  return store.find(symbol);
+}
+
 TimeSeriesRes Replay::time_series(const std::string& symbol,
                                   minutes) noexcept  //
 {
-  auto it = candles_by_sym.find(symbol);
-  if (it == candles_by_sym.end()) {
+  auto v = store.find(symbol);
+  if (v == nullptr) {
     spdlog::warn("[replay] no time series for {}", symbol.c_str());
     return {};
   }
 
-  auto& [candles, idx] = it->second;
   constexpr size_t min_sz = 300;
-  if (candles.size() < min_sz) {
+  if (v->size() < min_sz) {
     spdlog::warn("[replay] time series not long enough for {}", symbol.c_str());
     return {};
   }
 
-  return TimeSeriesRes{candles.begin(), candles.begin() + idx};
+  // the ticker owns its candles, so the history is copied out once
+  return v->slice(0, idx.at(symbol));
 }
 
-RealTimeRes Replay::real_time(const std::string& symbol, minutes) noexcept {
-  auto it = candles_by_sym.find(symbol);
-  if (it == candles_by_sym.end()) {
+RealTimeRes Replay::real_time(const std::string& symbol,
+                              minutes,
+                              Deadline) noexcept {
+  auto v = store.find(symbol);
+  if (v == nullptr) {
     spdlog::warn("[replay] no time series for {}", symbol.c_str());
     return {};
   }
-  auto& [candles, idx] = it->second;
-  return {candles[idx - 1], candles[idx]};
+
+  auto i = idx.at(symbol);
+  if (i == 0 || i >= v->size())
+    return {};
+  return {(*v)[i - 1], (*v)[i]};
 }
 
-void Replay::roll_fwd() noexcept {
-  for (auto& [_, tl] : candles_by_sym) {
-    tl.idx++;
+RealTimeBatch Replay::real_time(const std::vector<std::string>& symbols,
+                                minutes timeframe,
+                                Deadline deadline) noexcept {
+  RealTimeBatch res;
+  for (auto& symbol : symbols) {
+    auto rt = real_time(symbol, timeframe, deadline);
+    if (rt.second.time() != LocalTimePoint{})
+      res.try_emplace(symbol, std::move(rt));
   }
+  return res;
 }
 
-// FIXME fix
-void Replay::rollback(const std::string& symbol) {
-  auto it = candles_by_sym.find(symbol);
-  if (it == candles_by_sym.end()) {
-    spdlog::warn("[replay] no time series for {}", symbol.c_str());
+void Replay::roll_fwd() noexcept {
+  for (auto& [_, i] : idx)
+    i++;
+  n_ticks++;
+  sync_clock();
+}
+
+void Replay::roll_bwd() noexcept {
+  if (n_ticks == 0)
     return;
-  }
 
-  // if (time_idx == 0) {
-  //   time_idx = calls_per_hour - 1;
-  //   it->second.ids--;
-  // }
+  for (auto& [_, i] : idx)
+    if (i > 0)
+      i--;
+  n_ticks--;
+  sync_clock();
 }
 
+void Replay::sync_clock() const {
+  LocalTimePoint latest{};
+  for (auto& [symbol, i] : idx) {
+    auto v = store.find(symbol);
+    if (v != nullptr && i < v->size())
+      latest = std::max(latest, LocalTimePoint{seconds{v->time[i]}});
+  }
+  if (latest != LocalTimePoint{})
+    market_clock.set(latest);
+}
+
+// while any series has a candle left
 bool Replay::has_data() const {
-  if (candles_by_sym.empty())
-    return false;
-  auto& tl = candles_by_sym.begin()->second;
-  return tl.idx < tl.candles.size();
+  for (auto& [symbol, i] : idx)
+    if (auto v = store.find(symbol); v != nullptr && i < v->size())
+      return true;
+  return false;
 }
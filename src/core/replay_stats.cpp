@@ -0,0 +1,77 @@
+#include "core/replay_stats.h"
+#include "util/summary.h"
+#include "util/telemetry.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <format>
+
+inline constexpr const char* stage_names[] = {"fetch", "compute", "publish",
+                                              "pages"};
+
+void ReplayStats::add(Stage stage, double ms) {
+  static auto hists = [] {
+    std::array<Histogram*, N_STAGES> res;
+    for (size_t i = 0; i < N_STAGES; i++)
+      res[i] = &telemetry.histogram("fin_stage_ms",
+                                    "Latency of an update stage per item",
+                                    {{"stage", stage_names[i]}});
+    return res;
+  }();
+
+  auto i = static_cast<size_t>(stage);
+  stage_ns[i] += static_cast<int64_t>(ms * 1e6);
+  hists[i]->observe(ms);
+}
+
+void ReplayStats::add_step(double ms) {
+  static auto& hist = telemetry.histogram("fin_update_cycle_ms",
+                                          "Wall time of an update cycle");
+  hist.observe(ms);
+
+  std::lock_guard _{mtx};
+  step_ms.push_back(ms);
+}
+
+size_t ReplayStats::n_steps() {
+  std::lock_guard _{mtx};
+  return step_ms.size();
+}
+
+double peak_rss_mb() {
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0.0;
+  return usage.ru_maxrss / 1024.0;  // kB on linux
+}
+
+void ReplayStats::report(double total_s) {
+  std::lock_guard _{mtx};
+
+  auto n = n_candles.load();
+  summary("headless", "{} steps, {} candles in {:.2f}s, {:.0f} candles/s",
+          step_ms.size(), n, total_s, total_s > 0 ? n / total_s : 0.0);
+
+  if (!step_ms.empty()) {
+    auto sorted = step_ms;
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](double q) {
+      return sorted[static_cast<size_t>(q * (sorted.size() - 1))];
+    };
+    summary("headless", "step ms: p50 {:.2f}, p99 {:.2f}, max {:.2f}",
+            at(0.5), at(0.99), sorted.back());
+  }
+
+  double sum_ms = 0.0;
+  for (auto& ns : stage_ns)
+    sum_ms += ns.load() / 1e6;
+
+  for (size_t i = 0; i < N_STAGES; i++) {
+    auto ms = stage_ns[i].load() / 1e6;
+    summary("headless", "{:>8}: {:10.2f}ms {:5.1f}%", stage_names[i], ms,
+            sum_ms > 0 ? 100 * ms / sum_ms : 0.0);
+  }
+
+  summary("headless", "peak rss {:.1f}MB", peak_rss_mb());
+}
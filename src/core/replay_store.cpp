@@ -0,0 +1,194 @@
+#include "core/replay_store.h"
+
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+Candle CandleView::operator[](size_t i) const {
+  return {
+      .datetime = LocalTimePoint{seconds{time[i]}},
+      .open = open[i],
+      .high = high[i],
+      .low = low[i],
+      .close = close[i],
+      .volume = static_cast<int>(volume[i]),
+  };
+}
+
+TimeSeriesRes CandleView::slice(size_t from, size_t to) const {
+  TimeSeriesRes res;
+  to = std::min(to, size());
+  if (from >= to)
+    return res;
+
+  res.reserve(to - from);
+  for (auto i = from; i < to; i++)
+    res.push_back((*this)[i]);
+  return res;
+}
+
+ReplayStore::ReplayStore(const std::string& filename) noexcept {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+    return;
+
+  struct stat st;
+  if (::fstat(fd, &st) == -1 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return;
+  }
+
+  sz = static_cast<size_t>(st.st_size);
+  base = ::mmap(nullptr, sz, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    spdlog::error("[replay] mmap failed for {}", filename.c_str());
+    base = nullptr;
+    return;
+  }
+
+  auto* bytes = static_cast<const char*>(base);
+  auto* header = reinterpret_cast<const Header*>(bytes);
+  Header expected;
+  if (std::memcmp(header->magic, expected.magic, sizeof(expected.magic)) ||
+      header->version != expected.version) {
+    spdlog::error("[replay] {} has an unknown format", filename.c_str());
+    return;
+  }
+
+  auto dir_end = sizeof(Header) + header->n_symbols * sizeof(DirEntry);
+  if (dir_end > sz) {
+    spdlog::error("[replay] {} is truncated", filename.c_str());
+    return;
+  }
+
+  auto* dir = reinterpret_cast<const DirEntry*>(bytes + sizeof(Header));
+  for (size_t i = 0; i < header->n_symbols; i++) {
+    auto& e = dir[i];
+    if (e.offset + N_COLUMNS * e.n * 8 > sz) {
+      spdlog::error("[replay] {} is truncated", filename.c_str());
+      views.clear();
+      return;
+    }
+
+    auto col = [&](size_t k) { return bytes + e.offset + k * e.n * 8; };
+    auto ints = [&](size_t k) {
+      return std::span{reinterpret_cast<const int64_t*>(col(k)), e.n};
+    };
+    auto doubles = [&](size_t k) {
+      return std::span{reinterpret_cast<const double*>(col(k)), e.n};
+    };
+
+    std::string symbol{e.symbol, strnlen(e.symbol, sizeof(e.symbol))};
+    views.try_emplace(symbol, CandleView{
+                                  .time = ints(0),
+                                  .open = doubles(1),
+                                  .high = doubles(2),
+                                  .low = doubles(3),
+                                  .close = doubles(4),
+                                  .volume = ints(5),
+                                  .start = e.start,
+                              });
+  }
+}
+
+ReplayStore::~ReplayStore() noexcept {
+  if (base != nullptr)
+    ::munmap(base, sz);
+}
+
+ReplayStore::ReplayStore(ReplayStore&& other) noexcept
+    : base{std::exchange(other.base, nullptr)},
+      sz{std::exchange(other.sz, 0)},
+      views{std::move(other.views)} {}
+
+ReplayStore& ReplayStore::operator=(ReplayStore&& other) noexcept {
+  if (this != &other) {
+    if (base != nullptr)
+      ::munmap(base, sz);
+    base = std::exchange(other.base, nullptr);
+    sz = std::exchange(other.sz, 0);
+    views = std::move(other.views);
+  }
+  return *this;
+}
+
+bool ReplayStore::write(
+    const std::string& filename,
+    const std::unordered_map<std::string, ReplaySeries>& series) {
+  Header header{.n_symbols = series.size()};
+
+  std::vector<DirEntry> dir;
+  dir.reserve(series.size());
+
+  auto offset = sizeof(Header) + series.size() * sizeof(DirEntry);
+  for (auto& [symbol, s] : series) {
+    DirEntry e{.n = s.candles.size(), .start = s.start, .offset = offset};
+    if (symbol.size() >= sizeof(e.symbol)) {
+      spdlog::error("[replay] symbol {} too long", symbol.c_str());
+      return false;
+    }
+    std::memcpy(e.symbol, symbol.data(), symbol.size());
+    dir.push_back(e);
+    offset += N_COLUMNS * e.n * 8;
+  }
+
+  auto tmp = filename + ".tmp";
+  {
+    std::ofstream ofs{tmp, std::ios::binary | std::ios::trunc};
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(dir.data()),
+              dir.size() * sizeof(DirEntry));
+
+    auto put = [&](auto v) {
+      ofs.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    };
+
+    // same iteration order as the directory above
+    for (auto& [_, s] : series) {
+      auto& cs = s.candles;
+      for (auto& c : cs)
+        put(static_cast<int64_t>(c.time().time_since_epoch().count()));
+      for (auto& c : cs)
+        put(c.open);
+      for (auto& c : cs)
+        put(c.high);
+      for (auto& c : cs)
+        put(c.low);
+      for (auto& c : cs)
+        put(c.close);
+      for (auto& c : cs)
+        put(static_cast<int64_t>(c.volume));
+    }
+
+    if (!ofs) {
+      spdlog::error("[replay] error writing {}", tmp.c_str());
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  fs::rename(tmp, filename, ec);
+  if (ec) {
+    spdlog::error("[replay] error renaming {}: {}", tmp.c_str(),
+                  ec.message().c_str());
+    return false;
+  }
+  return true;
+}
+
+const CandleView* ReplayStore::find(const std::string& symbol) const {
+  auto it = views.find(symbol);
+  return it == views.end() ? nullptr : &it->second;
+}
@@ -0,0 +1,190 @@
+#include "core/schedule.h"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+// time from the start of a cycle until a ticker of this tier is recomputed
+inline constexpr double latency_target_ms[N_TIERS] = {
+    30'000,   // Held
+    60'000,   // High
+    180'000,  // Medium
+    420'000,  // Low
+};
+
+inline constexpr const char* tier_names[N_TIERS] = {
+    "held",
+    "high",
+    "medium",
+    "low",
+};
+
+Tier tier_of(const SymbolInfo& si, const OpenPositions& positions) {
+  if (positions.get_position(si.symbol) != nullptr)
+    return Tier::Held;
+  if (si.priority <= 1)
+    return Tier::High;
+  if (si.priority == 2)
+    return Tier::Medium;
+  return Tier::Low;
+}
+
+std::vector<SymbolInfo> by_priority(const Symbols& symbols,
+                                    const OpenPositions& positions,
+                                    size_t budget) {
+  std::vector<std::pair<Tier, const SymbolInfo*>> ranked;
+  ranked.reserve(symbols.size());
+  for (auto& si : symbols)
+    ranked.emplace_back(tier_of(si, positions), &si);
+
+  // stable, so file order is kept within a tier
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](auto& l, auto& r) { return l.first < r.first; });
+
+  if (ranked.size() > budget) {
+    for (auto it = ranked.begin() + budget; it != ranked.end(); it++)
+      spdlog::warn("[schedule] ({}) skipped, out of api budget",
+                   it->second->symbol.c_str());
+    ranked.resize(budget);
+  }
+
+  std::vector<SymbolInfo> out;
+  out.reserve(ranked.size());
+  for (auto it = ranked.rbegin(); it != ranked.rend(); it++)
+    out.push_back(*it->second);
+  return out;
+}
+
+std::vector<std::vector<SymbolInfo>> in_batches(std::vector<SymbolInfo> queue,
+                                                size_t n) {
+  std::vector<std::vector<SymbolInfo>> batches;
+  if (n == 0)
+    return batches;
+
+  batches.reserve((queue.size() + n - 1) / n);
+  while (!queue.empty()) {
+    auto k = std::min(n, queue.size());
+    batches.emplace_back(std::make_move_iterator(queue.end() - k),
+                         std::make_move_iterator(queue.end()));
+    queue.resize(queue.size() - k);
+  }
+
+  std::reverse(batches.begin(), batches.end());
+  return batches;
+}
+
+void TierLatency::add(Tier tier, double ms) {
+  std::lock_guard _{mtx};
+  auto& e = entries[static_cast<size_t>(tier)];
+  e.n++;
+  e.sum_ms += ms;
+  e.max_ms = std::max(e.max_ms, ms);
+}
+
+void TierLatency::report(const std::string& tag) const {
+  std::lock_guard _{mtx};
+  for (size_t i = 0; i < N_TIERS; i++) {
+    auto& e = entries[i];
+    if (e.n == 0)
+      continue;
+
+    auto target = latency_target_ms[i];
+    auto level = e.max_ms > target ? spdlog::level::warn : spdlog::level::info;
+    spdlog::log(level,
+                "[{}] {}: n {} avg {:.0f}ms max {:.0f}ms target {:.0f}ms",
+                tag.c_str(), tier_names[i], e.n, e.sum_ms / e.n, e.max_ms,
+                target);
+  }
+}
+
+inline double demand_weight(const RefreshDemand& d) {
+  return 1.0                                 //
+         + (d.held ? 2.0 : 0.0)              //
+         + std::min(d.atr_pct / 0.02, 2.0)   //
+         + std::clamp(d.proximity, 0.0, 1.0);
+}
+
+inline minutes wanted_cadence(double weight) {
+  if (weight >= 3.5)
+    return M_15;
+  if (weight >= 2.5)
+    return M_30;
+  return H_1;
+}
+
+RefreshPlan::RefreshPlan(std::vector<RefreshDemand> demands,
+                         size_t daily_quota,
+                         size_t minute_quota,
+                         seconds monitor_every) {
+  std::vector<std::pair<double, const RefreshDemand*>> ranked;
+  ranked.reserve(demands.size());
+  for (auto& d : demands)
+    ranked.emplace_back(demand_weight(d), &d);
+
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](auto& l, auto& r) { return l.first > r.first; });
+
+  // the stop monitor prices every held name once a poll through market
+  // hours, at `monitor_every` or slower so it stays within a quarter of the
+  // daily quota
+  auto n_held = static_cast<size_t>(std::count_if(
+      demands.begin(), demands.end(), [](auto& d) { return d.held; }));
+  size_t monitor_calls = 0;
+  if (n_held > 0) {
+    constexpr seconds market = hours{6} + minutes{30};
+    auto cap = std::max<size_t>(daily_quota / 4, 1);
+    auto slowest = seconds{static_cast<seconds::rep>(
+        (n_held * market.count() + cap - 1) / cap)};
+    monitor = std::max(monitor_every, slowest);
+    monitor_calls = n_held * static_cast<size_t>(market / monitor);
+  }
+
+  // a tenth of the daily quota is kept for SPY and ad-hoc calls. the calls
+  // due on a sub-hour tick have to fit in half of the minute quota spread
+  // over that tick, or they'd spill into the next one.
+  auto budget = daily_quota - daily_quota / 10 - monitor_calls;
+  auto burst_cap = minute_quota * M_15.count() / 2;
+
+  size_t used = candles_per_day(H_1) * demands.size();
+  size_t n_sub_hour = 0;
+
+  for (auto [weight, d] : ranked) {
+    auto cad = H_1;
+    for (auto want : {M_15, M_30}) {
+      if (want < wanted_cadence(weight))
+        continue;
+
+      auto extra = candles_per_day(want) - candles_per_day(H_1);
+      if (used + extra > budget || n_sub_hour + 1 > burst_cap)
+        continue;
+
+      used += extra;
+      n_sub_hour++;
+      cad = want;
+      break;
+    }
+
+    cadence.try_emplace(d->symbol, cad);
+    tick = std::min(tick, cad);
+  }
+
+  spdlog::info(
+      "[plan] {} sub-hour refreshes, tick {}, monitor {}s, {}/{} daily calls",
+      n_sub_hour, tick.count(), monitor.count(), used + monitor_calls,
+      daily_quota);
+}
+
+minutes RefreshPlan::cadence_of(const std::string& symbol) const {
+  auto it = cadence.find(symbol);
+  return it == cadence.end() ? H_1 : it->second;
+}
+
+bool RefreshPlan::due(const std::string& symbol, LocalTimePoint tp) const {
+  // market_status wakes the loop on multiples of `tick` since midnight,
+  // slightly late, so round to the nearest tick first
+  auto since_midnight = std::chrono::floor<minutes>(tp - floor<days>(tp));
+  auto mins = since_midnight.count();
+  auto t = (mins + tick.count() / 2) / tick.count() * tick.count();
+  return t % cadence_of(symbol).count() == 0;
+}
@@ -1,53 +1,11 @@
-#include "core/replay.h"
 #include "ind/candle.h"
 #include "util/times.h"
 
 #include <spdlog/spdlog.h>
-#include <fstream>
 #include <glaze/glaze.hpp>
 
-#include <cereal/archives/binary.hpp>
-#include <cereal/types/string.hpp>
-#include <cereal/types/unordered_map.hpp>
-#include <cereal/types/vector.hpp>
-
 #include <cpr/cpr.h>
 
-namespace cereal {
-template <class Archive>
-void save(Archive& ar, const Candle& c) {
-  LocalTimePoint tp = c.time();
-  auto secs = tp.time_since_epoch().count();
-  ar(secs, c.open, c.high, c.low, c.close, c.volume);
-}
-
-template <class Archive>
-void load(Archive& ar, Candle& c) {
-  std::int64_t secs;
-  ar(secs, c.open, c.high, c.low, c.close, c.volume);
-  c.datetime = LocalTimePoint{std::chrono::seconds{secs}};
-}
-
-template <class Archive>
-void serialize(Archive& ar, Timeline& t) {
-  ar(t.candles, t.idx);
-}
-}  // namespace cereal
-
-void write_candles(const std::string& filename, const CandleStore& data) {
-  std::ofstream ofs(filename, std::ios::binary);
-  cereal::BinaryOutputArchive oarchive(ofs);
-  oarchive(data);
-}
-
-CandleStore read_candles(const std::string& filename) {
-  std::unordered_map<std::string, Timeline> data;
-  std::ifstream ifs(filename, std::ios::binary);
-  cereal::BinaryInputArchive iarchive(ifs);
-  iarchive(data);
-  return data;
-}
-
 template <>
 struct glz::meta<LocalTimePoint> {
   using T = LocalTimePoint;
@@ -86,6 +44,82 @@ TimeSeriesRes read_candles_json(const std::string& str) {
   return ts_res.values;
 }
 
+// batch responses are keyed by symbol, with a status per entry
+struct BatchRes {
+  std::string status;
+  std::string message;
+  TimeSeriesRes values;
+};
+
+std::unordered_map<std::string, TimeSeriesRes> read_batch_json(
+    const std::string& str) {
+  constexpr auto opts = glz::opts{
+      .error_on_unknown_keys = false,
+      .quoted_num = true,
+  };
+
+  std::unordered_map<std::string, BatchRes> batch;
+  auto ec = glz::read<opts>(batch, str);
+  if (ec) {
+    spdlog::error("[td] batch json error: {}", glz::format_error(ec));
+    return {};
+  }
+
+  std::unordered_map<std::string, TimeSeriesRes> res;
+  for (auto& [symbol, entry] : batch) {
+    if (entry.status != "ok") {
+      spdlog::warn("[td] ({}) batch error: {}", symbol.c_str(),
+                   entry.message.c_str());
+      continue;
+    }
+    res.try_emplace(symbol, std::move(entry.values));
+  }
+  return res;
+}
+
+struct PriceRes {
+  double price = 0.0;
+};
+
+double read_price_json(const std::string& str) {
+  constexpr auto opts = glz::opts{
+      .error_on_unknown_keys = false,
+      .quoted_num = true,
+  };
+
+  PriceRes res;
+  auto ec = glz::read<opts>(res, str);
+  if (ec) {
+    spdlog::error("[td] price json error: {}", glz::format_error(ec));
+    return 0.0;
+  }
+
+  return res.price;
+}
+
+// a /price call for several symbols is keyed by symbol, with an error
+// object, read as no price, in place of any symbol that failed
+std::unordered_map<std::string, double> read_prices_json(
+    const std::string& str) {
+  constexpr auto opts = glz::opts{
+      .error_on_unknown_keys = false,
+      .quoted_num = true,
+  };
+
+  std::unordered_map<std::string, PriceRes> batch;
+  auto ec = glz::read<opts>(batch, str);
+  if (ec) {
+    spdlog::error("[td] prices json error: {}", glz::format_error(ec));
+    return {};
+  }
+
+  std::unordered_map<std::string, double> res;
+  for (auto& [symbol, entry] : batch)
+    if (entry.price > 0.0)
+      res.try_emplace(symbol, entry.price);
+  return res;
+}
+
 struct fx_res_t {
   std::unordered_map<std::string, double> rates;
 };
@@ -0,0 +1,260 @@
+#include "core/simulator.h"
+#include "mt/sleeper.h"
+#include "mt/thread_pool.h"
+#include "util/config.h"
+#include "util/summary.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <mutex>
+
+// the latest time by which every symbol has `warmup` candles
+inline LocalTimePoint start_time(const Symbols& symbols,
+                                 const ReplayStore& store,
+                                 size_t warmup) {
+  LocalTimePoint from{};
+  for (auto& si : symbols) {
+    auto v = store.find(si.symbol);
+    if (v != nullptr && v->size() > warmup)
+      from = std::max(from, LocalTimePoint{seconds{v->time[warmup]}});
+  }
+  return from;
+}
+
+// first candle at or after `tp`
+inline size_t index_at(const CandleView& v, LocalTimePoint tp) {
+  auto t = tp.time_since_epoch().count();
+  return std::lower_bound(v.time.begin(), v.time.end(), t) - v.time.begin();
+}
+
+// spy only gets a day once it has closed, so no step sees its own day's close
+inline LocalTimePoint spy_cutoff(LocalTimePoint t) {
+  return LocalTimePoint{floor<days>(t)};
+}
+
+inline std::string to_date(LocalTimePoint tp) {
+  return std::format("{:%F %T}", tp);
+}
+
+Simulator::Simulator(const Symbols& symbols,
+                     const ReplayStore& store,
+                     double capital,
+                     size_t warmup) noexcept
+    : store{store},
+      spy{[&] {
+        auto v = store.find("SPY");
+        auto from = spy_cutoff(start_time(symbols, store, warmup));
+        return v ? v->slice(0, index_at(*v, from)) : TimeSeriesRes{};
+      }(),
+          D_1},
+      positions{Trades{}},
+      cash{capital},
+      peak{capital}  //
+{
+  res.capital = capital;
+
+  auto from = start_time(symbols, store, warmup);
+  if (auto v = store.find("SPY"))
+    spy_idx = index_at(*v, spy_cutoff(from));
+
+  std::mutex mtx;
+  auto func = [&, this](SymbolInfo&& si) {
+    if (sleeper.should_shutdown())
+      return false;
+
+    auto v = store.find(si.symbol);
+    if (v == nullptr || v->size() <= warmup)
+      return true;
+
+    auto start = index_at(*v, from);
+    Ticker ticker{si, Event{}, spy, positions, v->slice(0, start), H_1,
+                  nullptr};
+
+    std::lock_guard _{mtx};
+    idx.try_emplace(si.symbol, start);
+    tickers.try_emplace(si.symbol, std::move(ticker));
+    return true;
+  };
+
+  {
+    thread_pool<SymbolInfo> pool{config.n_concurrency, func, symbols.arr};
+  }
+
+  spdlog::info("[sim] {} tickers from {}", tickers.size(), to_date(from));
+}
+
+LocalTimePoint Simulator::next_time() const {
+  auto t = LocalTimePoint::max();
+  for (auto& [symbol, i] : idx) {
+    auto v = store.find(symbol);
+    if (i < v->size())
+      t = std::min(t, LocalTimePoint{seconds{v->time[i]}});
+  }
+  return t;
+}
+
+void Simulator::fill(LocalTimePoint t) {
+  std::vector<Order> pending;
+
+  for (auto& o : orders) {
+    auto v = store.find(o.symbol);
+    auto i = idx.at(o.symbol);
+    if (i >= v->size() || LocalTimePoint{seconds{v->time[i]}} != t) {
+      pending.push_back(std::move(o));
+      continue;
+    }
+
+    // conditional orders only live for the next candle
+    auto c = (*v)[i];
+    double px = c.open;
+    if (o.trigger > 0.0) {
+      bool buy = o.action == Action::BUY;
+      if (buy ? c.high < o.trigger : c.low > o.trigger)
+        continue;
+      px = buy ? std::max(c.open, o.trigger) : std::min(c.open, o.trigger);
+    }
+
+    auto pos = positions.get_position(o.symbol);
+    auto qty = o.qty;
+    if (o.action == Action::BUY)
+      qty = std::min(qty, cash / px);
+    else
+      qty = std::min(qty, pos ? pos->qty : 0.0);
+    if (qty <= 1e-6)
+      continue;
+
+    Trade trade{to_date(t), o.symbol, o.action, qty, px, qty * px, o.remark};
+    cash += o.action == Action::BUY ? -trade.total : trade.total;
+    positions.add_trade(trade);
+    res.trades[o.symbol].push_back(std::move(trade));
+
+    tickers.at(o.symbol).update_position(positions.get_position(o.symbol));
+  }
+
+  orders = std::move(pending);
+}
+
+void Simulator::step(const std::vector<std::string>& symbols) {
+  auto func = [this](std::string&& symbol) {
+    auto& ticker = tickers.at(symbol);
+    auto i = idx.at(symbol);
+    ticker.push_back((*store.find(symbol))[i],
+                     positions.get_position(symbol));
+    return true;
+  };
+
+  {
+    thread_pool<std::string> pool{config.n_concurrency, func, symbols};
+  }
+
+  for (auto& symbol : symbols)
+    idx.at(symbol)++;
+}
+
+void Simulator::decide(const std::vector<std::string>& symbols) {
+  for (auto& symbol : symbols) {
+    auto& ticker = tickers.at(symbol);
+    auto& risk = ticker.risk;
+    auto& scaling = risk.scaling;
+
+    auto pos = positions.get_position(symbol);
+    if (pos == nullptr) {
+      if (ticker.signal.type == Rating::Entry && risk.can_take_position() &&
+          risk.sizing.rec_shares > 0)
+        orders.push_back({symbol, Action::BUY, risk.sizing.rec_shares, 0.0,
+                          "entry"});
+      continue;
+    }
+
+    if (ticker.signal.type == Rating::Exit)
+      orders.push_back({symbol, Action::SELL, pos->qty, 0.0, "exit"});
+    else if (scaling.should_trim)
+      orders.push_back({symbol, Action::SELL, scaling.trim_size_shares,
+                        scaling.trim_trigger_price, "trim"});
+    else if (scaling.can_add)
+      orders.push_back({symbol, Action::BUY, scaling.add_size_shares,
+                        scaling.add_trigger_price, "add"});
+  }
+}
+
+void Simulator::mark(LocalTimePoint t) {
+  double equity = cash;
+  for (auto& [symbol, pos] : positions.get_positions())
+    equity += pos.qty * tickers.at(symbol).metrics.last_price();
+
+  peak = std::max(peak, equity);
+
+  auto dd = peak > 0 ? 1.0 - equity / peak : 0.0;
+  res.max_drawdown = std::max(res.max_drawdown, dd);
+  res.equity.push_back({t, equity, cash, dd});
+}
+
+SimResult Simulator::run() {
+  auto spy_view = store.find("SPY");
+
+  while (!sleeper.should_shutdown()) {
+    auto t = next_time();
+    if (t == LocalTimePoint::max())
+      break;
+
+    market_clock.set(t);
+
+    while (spy_view && spy_idx < spy_view->size() &&
+           LocalTimePoint{seconds{spy_view->time[spy_idx]}} < spy_cutoff(t))
+      spy.push_back((*spy_view)[spy_idx++]);
+
+    fill(t);
+
+    std::vector<std::string> symbols;
+    for (auto& [symbol, i] : idx) {
+      auto v = store.find(symbol);
+      if (i < v->size() && LocalTimePoint{seconds{v->time[i]}} == t)
+        symbols.push_back(symbol);
+    }
+
+    step(symbols);
+    decide(symbols);
+    mark(t);
+    res.n_steps++;
+  }
+
+  market_clock.live();
+  return std::move(res);
+}
+
+void SimResult::write_csv() const {
+  std::ofstream eq("data/sim_equity.csv");
+  eq << "datetime,equity,cash,drawdown\n";
+  for (auto& e : equity)
+    eq << std::format("{:%F %T},{:.2f},{:.2f},{:.4f}\n", e.time, e.equity,
+                      e.cash, e.drawdown);
+
+  std::vector<const Trade*> all;
+  for (auto& [_, ts] : trades)
+    for (auto& t : ts)
+      all.push_back(&t);
+  std::stable_sort(all.begin(), all.end(), [](auto* a, auto* b) {
+    return std::tie(a->date, a->ticker) < std::tie(b->date, b->ticker);
+  });
+
+  std::ofstream tr("data/sim_trades.csv");
+  tr << "date,ticker,action,qty,price,total,remark\n";
+  for (auto* t : all)
+    tr << std::format("{},{},{},{:.4f},{:.2f},{:.2f},{}\n", t->date, t->ticker,
+                      t->action == Action::BUY ? "BUY" : "SELL", t->qty,
+                      t->px, t->total, t->remark);
+}
+
+void SimResult::report(double total_s) const {
+  size_t n_trades = 0;
+  for (auto& [_, ts] : trades)
+    n_trades += ts.size();
+
+  auto ret = capital > 0 ? final_equity() / capital - 1.0 : 0.0;
+  summary("sim", "{} steps in {:.2f}s, {} trades", n_steps, total_s, n_trades);
+  summary("sim", "equity {:.2f} -> {:.2f} ({:+.2f}%), max drawdown {:.2f}%",
+          capital, final_equity(), ret * 100, max_drawdown * 100);
+}
@@ -0,0 +1,90 @@
+#include "core/portfolio.h"
+#include "mt/sleeper.h"
+#include "util/config.h"
+
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+
+// called by whoever just recomputed the ticker's Risk
+void Portfolio::publish_levels(const std::string& symbol,
+                               const Ticker& ticker) {
+  auto& risk = ticker.risk;
+  StopLevels l{risk.stop_loss.get_stop_price(), risk.target.target_price};
+
+  std::lock_guard _{levels_mtx};
+  levels[symbol] = l;
+}
+
+// Polls the last trade of every open position between candle updates and
+// checks it against the stop and target last published for the ticker, so a
+// breach is reported within one poll instead of at the next 1h candle. All
+// held names are priced in one call per poll, at the interval the refresh
+// plan set aside credits for. Each level is alerted once; a moved stop or
+// target re-arms it.
+void Portfolio::monitor_stops() {
+  std::unordered_map<std::string, double> stop_alerted, target_alerted;
+
+  auto interval = [this] {
+    auto every = monitor_interval.load();
+    return every > seconds{0} ? every
+                              : seconds{config.risk_config.stop_monitor_secs};
+  };
+
+  while (sleeper.sleep_for(interval())) {
+    if (!is_market_hours(now_ny_time()))
+      continue;
+
+    std::vector<std::string> held;
+    {
+      auto _ = reader_lock();
+      for (auto& [symbol, pos] : get_positions())
+        held.push_back(symbol);
+    }
+
+    std::vector<std::pair<std::string, StopLevels>> watch;
+    std::vector<std::string> symbols;
+    {
+      std::lock_guard _{levels_mtx};
+      for (auto& symbol : held) {
+        auto it = levels.find(symbol);
+        if (it == levels.end())
+          continue;
+        watch.emplace_back(symbol, it->second);
+        symbols.push_back(symbol);
+      }
+    }
+
+    if (symbols.empty())
+      continue;
+
+    auto prices = td.prices(symbols);
+    if (sleeper.should_shutdown())
+      return;
+
+    for (auto& [symbol, l] : watch) {
+      auto it = prices.find(symbol);
+      if (it == prices.end())
+        continue;
+      auto price = it->second;
+      auto [stop, target] = l;
+
+      if (stop > 0.0 && price < stop && stop_alerted[symbol] != stop) {
+        stop_alerted[symbol] = stop;
+        spdlog::warn("[monitor] ({}) stop hit {:.2f} < {:.2f}", symbol.c_str(),
+                     price, stop);
+        send_to_broker(TG_ID, "send",
+                       {{"str", std::format("*STOP HIT* {}: {:.2f} < {:.2f}",
+                                            symbol, price, stop)}});
+      }
+
+      if (target > 0.0 && price >= target && target_alerted[symbol] != target) {
+        target_alerted[symbol] = target;
+        spdlog::info("[monitor] ({}) target hit {:.2f} >= {:.2f}",
+                     symbol.c_str(), price, target);
+        send_to_broker(TG_ID, "send",
+                       {{"str", std::format("*TARGET* {}: {:.2f} >= {:.2f}",
+                                            symbol, price, target)}});
+      }
+    }
+  }
+}
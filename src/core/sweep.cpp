@@ -0,0 +1,306 @@
+#include "core/sweep.h"
+#include "ind/indicators.h"
+#include "mt/sleeper.h"
+#include "mt/thread_pool.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <glaze/glaze.hpp>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+
+std::optional<SweepSpec> SweepSpec::read(const std::string& path) {
+  SweepSpec spec;
+  auto ec = glz::read_file_json(spec, path, std::string{});
+  if (ec) {
+    spdlog::error("[sweep] error reading {}: {}", path.c_str(),
+                  glz::format_error(ec).c_str());
+    return std::nullopt;
+  }
+  return spec;
+}
+
+Sweep::Sweep(const Symbols& symbols, const ReplayStore& store, size_t warmup) {
+  constexpr auto day = candles_per_day(H_1);
+  constexpr auto refit = refit_days * day;
+
+  std::mutex mtx;
+  auto func = [&, this](SymbolInfo&& si) {
+    if (sleeper.should_shutdown())
+      return false;
+
+    auto v = store.find(si.symbol);
+    if (v == nullptr || v->size() <= warmup + 1)
+      return true;
+
+    Series s;
+    s.symbol = si.symbol;
+    auto n = v->size() - warmup;
+    s.evidence.reserve(n);
+
+    // walk forward: stats and S/R are refit from the candles ahead of each
+    // refit point only, and the candles up to the next one are pushed like
+    // live updates, so no evidence sees a later candle
+    std::optional<Indicators> ind;
+    for (auto i = warmup; i < v->size(); i++) {
+      if ((i - warmup) % refit == 0)
+        ind.emplace(v->slice(0, i), H_1);
+      ind->push_back((*v)[i]);
+
+      s.evidence.emplace_back(*ind, -1);
+      s.open.push_back(v->open[i]);
+      s.high.push_back(v->high[i]);
+      s.low.push_back(v->low[i]);
+      s.close.push_back(v->close[i]);
+      s.atr.push_back(ind->atr(-1));
+      s.fwd.push_back(i + day < v->size() ? v->close[i + day] / v->close[i] - 1
+                                          : std::nan(""));
+    }
+
+    std::lock_guard _{mtx};
+    series.push_back(std::move(s));
+    return true;
+  };
+
+  {
+    thread_pool<SymbolInfo> pool{config.n_concurrency, func, symbols.arr};
+  }
+
+  // sums over symbols run in a fixed order
+  std::sort(series.begin(), series.end(),
+            [](auto& a, auto& b) { return a.symbol < b.symbol; });
+
+  spdlog::info("[sweep] shared work done for {} symbols", series.size());
+}
+
+SweepResult Sweep::evaluate(size_t trial, const SweepTrial& t) const {
+  SweepResult res{.trial = trial};
+
+  auto& sig = t.sig;
+  auto& risk = t.risk;
+  auto max_hold = static_cast<size_t>(std::max(risk.max_hold_days, 1)) *
+                  candles_per_day(H_1);
+
+  for (auto& s : series) {
+    bool in = false, buy = false, sell = false;
+    double entry = 0.0, stop = 0.0, target = 0.0;
+    size_t held = 0;
+
+    auto close_trade = [&](double px) {
+      auto ret = px / entry - 1;
+      res.n_trades++;
+      res.n_wins += ret > 0;
+      res.pnl_pct += ret * 100;
+      res.pnl_r += (px - entry) / (entry - stop);
+      in = false;
+    };
+
+    for (size_t i = 0; i < s.evidence.size(); i++) {
+      // orders decided on the last close fill at this open
+      if (buy) {
+        entry = s.open[i];
+        stop = entry - risk.stop_atr_multiplier_base * s.atr[i - 1];
+        target = entry + risk.target_rr_ratio * (entry - stop);
+        in = true;
+        held = 0;
+      } else if (sell) {
+        close_trade(s.open[i]);
+      }
+      buy = sell = false;
+
+      if (in && s.low[i] <= stop)
+        close_trade(std::min(s.open[i], stop));
+      else if (in && s.high[i] >= target)
+        close_trade(std::max(s.open[i], target));
+
+      auto& ev = s.evidence[i];
+      auto [entry_w, exit_w] = ev.weigh(sig);
+      auto rating = ev.rate(entry_w, exit_w, sig);
+
+      if (rating == Rating::Entry) {
+        res.n_entry++;
+        res.n_entry_right += s.fwd[i] > 0;
+      } else if (rating == Rating::Exit) {
+        res.n_exit++;
+      }
+
+      if (in) {
+        sell = rating == Rating::Exit || ++held >= max_hold;
+      } else if (rating == Rating::Entry && s.atr[i] > 0) {
+        auto score = gen_score(entry_w, exit_w, sig);
+        buy = score >= risk.entry_score_cutoff;
+      }
+    }
+
+    // still open at the end, marked at the last close
+    if (in)
+      close_trade(s.close.back());
+  }
+
+  return res;
+}
+
+std::vector<SweepResult> Sweep::run(
+    const std::vector<SweepTrial>& trials) const {
+  std::vector<SweepResult> results(trials.size());
+
+  std::vector<size_t> ids(trials.size());
+  for (size_t i = 0; i < ids.size(); i++)
+    ids[i] = i;
+
+  auto func = [&, this](size_t&& i) {
+    if (sleeper.should_shutdown())
+      return false;
+    results[i] = evaluate(i, trials[i]);
+    return true;
+  };
+
+  {
+    thread_pool<size_t> pool{config.n_concurrency, func, std::move(ids)};
+  }
+
+  return results;
+}
+
+// the parameters a sweep can vary. the lookbacks of the reasons aren't here,
+// as they change the reasons themselves and so the shared work.
+inline const std::map<std::string, double SignalConfig::*> sig_params = {
+    {"entry_threshold", &SignalConfig::entry_threshold},
+    {"exit_threshold", &SignalConfig::exit_threshold},
+    {"watchlist_threshold", &SignalConfig::watchlist_threshold},
+    {"mixed_min", &SignalConfig::mixed_min},
+    {"score_entry_weight", &SignalConfig::score_entry_weight},
+    {"score_hint_weight", &SignalConfig::score_hint_weight},
+    {"score_squash_factor", &SignalConfig::score_squash_factor},
+    {"stop_reason_importance", &SignalConfig::stop_reason_importance},
+    {"stop_hint_importance", &SignalConfig::stop_hint_importance},
+};
+
+inline const std::map<std::string, double RiskConfig::*> risk_params = {
+    {"stop_atr_multiplier_base", &RiskConfig::stop_atr_multiplier_base},
+    {"target_rr_ratio", &RiskConfig::target_rr_ratio},
+    {"entry_score_cutoff", &RiskConfig::entry_score_cutoff},
+};
+
+inline const std::map<std::string, int RiskConfig::*> risk_int_params = {
+    {"max_hold_days", &RiskConfig::max_hold_days},
+};
+
+inline bool set_param(SweepTrial& t, const std::string& name, double v) {
+  if (auto it = sig_params.find(name); it != sig_params.end())
+    t.sig.*(it->second) = v;
+  else if (auto it = risk_params.find(name); it != risk_params.end())
+    t.risk.*(it->second) = v;
+  else if (auto it = risk_int_params.find(name); it != risk_int_params.end())
+    t.risk.*(it->second) = static_cast<int>(std::lround(v));
+  else
+    return false;
+  return true;
+}
+
+std::vector<SweepTrial> sweep_trials(const SweepSpec& spec,
+                                     const SignalConfig& sig,
+                                     const RiskConfig& risk) {
+  std::vector<std::pair<std::string, std::vector<double>>> params;
+  for (auto& [name, values] : spec.params) {
+    SweepTrial probe;
+    if (values.empty() || !set_param(probe, name, values.front())) {
+      spdlog::error("[sweep] can't sweep {}", name.c_str());
+      return {};
+    }
+    params.emplace_back(name, values);
+  }
+
+  std::vector<std::vector<double>> points;
+  if (spec.mode == "random") {
+    std::mt19937_64 gen{spec.seed};
+    for (size_t k = 0; k < spec.n; k++) {
+      auto& point = points.emplace_back();
+      for (auto& [_, values] : params) {
+        auto [lo, hi] = std::minmax_element(values.begin(), values.end());
+        point.push_back(std::uniform_real_distribution{*lo, *hi}(gen));
+      }
+    }
+  } else {
+    // odometer over the value lists
+    std::vector<size_t> at(params.size(), 0);
+    while (true) {
+      auto& point = points.emplace_back();
+      for (size_t p = 0; p < params.size(); p++)
+        point.push_back(params[p].second[at[p]]);
+
+      size_t p = 0;
+      for (; p < params.size(); p++) {
+        if (++at[p] < params[p].second.size())
+          break;
+        at[p] = 0;
+      }
+      if (p == params.size())
+        break;
+    }
+  }
+
+  std::vector<SweepTrial> trials;
+  trials.reserve(points.size());
+  for (auto& point : points) {
+    SweepTrial t;
+    t.sig = sig;
+    t.risk = risk;
+    for (size_t p = 0; p < params.size(); p++) {
+      set_param(t, params[p].first, point[p]);
+      t.params.emplace_back(params[p].first, point[p]);
+    }
+    trials.push_back(std::move(t));
+  }
+
+  return trials;
+}
+
+void report_sweep(const std::vector<SweepTrial>& trials,
+                  std::vector<SweepResult> results) {
+  std::stable_sort(results.begin(), results.end(), [](auto& a, auto& b) {
+    return a.pnl_pct > b.pnl_pct;
+  });
+
+  auto pct = [](size_t a, size_t b) { return b > 0 ? 100.0 * a / b : 0.0; };
+
+  auto row = [&](size_t rank, const SweepResult& r) {
+    std::string params;
+    for (auto& [name, v] : trials[r.trial].params)
+      params += std::format("{}={:.4g} ", name, v);
+    return std::format(
+        "{:>4} {:>7} {:>5.1f}% {:>+9.2f}% {:>+8.2f}R {:>7} {:>5.1f}% {:>6}  {}",
+        rank, r.n_trades, pct(r.n_wins, r.n_trades), r.pnl_pct, r.pnl_r,
+        r.n_entry, pct(r.n_entry_right, r.n_entry), r.n_exit, params);
+  };
+
+  std::ofstream f("data/sweep.csv");
+  f << "rank";
+  if (!trials.empty())
+    for (auto& [name, _] : trials.front().params)
+      f << "," << name;
+  f << ",trades,win_pct,pnl_pct,pnl_r,entries,entry_hit_pct,exits\n";
+
+  for (size_t i = 0; i < results.size(); i++) {
+    auto& r = results[i];
+    f << i + 1;
+    for (auto& [_, v] : trials[r.trial].params)
+      f << "," << v;
+    f << std::format(",{},{:.2f},{:.4f},{:.4f},{},{:.2f},{}\n", r.n_trades,
+                     pct(r.n_wins, r.n_trades), r.pnl_pct, r.pnl_r, r.n_entry,
+                     pct(r.n_entry_right, r.n_entry), r.n_exit);
+  }
+
+  std::cout << std::format("{:>4} {:>7} {:>6} {:>10} {:>9} {:>7} {:>6} {:>6}",
+                           "rank", "trades", "win", "pnl", "pnl_r", "entries",
+                           "hit", "exits")
+            << std::endl;
+  for (size_t i = 0; i < std::min<size_t>(results.size(), 10); i++)
+    std::cout << row(i + 1, results[i]) << std::endl;
+}
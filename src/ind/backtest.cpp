@@ -1,6 +1,8 @@
 #include "ind/backtest.h"
 #include "ind/indicators.h"
+#include "sig/rule_profile.h"
 #include "util/config.h"
+#include "util/trace.h"
 
 #include <cmath>
 
@@ -63,8 +65,12 @@ inline constexpr bool ignore_backtest(Source src) {
   return src == Source::Stop || src == Source::SR;
 }
 
+minutes Backtest::interval() const {
+  return ind.interval;
+}
+
 template <typename T, typename Func>
-std::pair<T, SignalStats> Backtest::get_stats(Func fn) const {
+std::pair<T, SignalStats> Backtest::get_stats(Func fn, RuleStats* prof) const {
   size_t sample_size = 0;
   double sum_pnl = 0.0;
   double sum_squared_pnl = 0.0;
@@ -80,7 +86,7 @@ std::pair<T, SignalStats> Backtest::get_stats(Func fn) const {
   auto start = lookback > ind.size() ? 0 : ind.size() - lookback;
 
   for (size_t i = start; i < ind.size(); ++i) {
-    auto r = fn(ind, i);
+    auto r = profiled(prof, fn, ind, i);
     if (!r.exists() || ignore_backtest(r.source()))
       continue;
 
@@ -192,7 +198,14 @@ double SignalStats::calculate_importance() const {
   return base_score * sample_penalty;
 }
 
+Stats::Stats(const IndicatorsTrends& ind) {
+  Span _{"stats"};
+  Backtest bt{ind};
+  reason = get_reason_stats(bt);
+  hint = get_hint_stats(bt);
+}
+
 template std::pair<ReasonType, SignalStats>  //
-    Backtest::get_stats<ReasonType, signal_f>(signal_f) const;
+    Backtest::get_stats<ReasonType, signal_f>(signal_f, RuleStats*) const;
 template std::pair<HintType, SignalStats>  //
-    Backtest::get_stats<HintType, hint_f>(hint_f) const;
+    Backtest::get_stats<HintType, hint_f>(hint_f, RuleStats*) const;
@@ -1,7 +1,7 @@
 #include "ind/calendar.h"
+#include "mt/http.h"
 #include "util/times.h"
 
-#include <cpr/cpr.h>
 #include <spdlog/spdlog.h>
 #include <chrono>
 #include <glaze/glaze.hpp>
@@ -32,13 +32,20 @@ struct glz::meta<LocalTimePoint> {
   static constexpr auto value = custom<read, write>;
 };
 
-inline auto fetch_nasdaq_events(auto& event_type, auto& date) {
-  EventsMap events;
+inline constexpr size_t MAX_IN_FLIGHT = 6;
 
-  auto url = std::format("https://api.nasdaq.com/api/calendar/{}?date={:%F}",
-                         event_type, date);
-  cpr::Response r =
-      cpr::Get(cpr::Url{url}, cpr::Header{{"User-Agent", "Mozilla/5.0"}});
+inline http::Request nasdaq_request(auto& event_type, auto& date) {
+  return {
+      .url = std::format("https://api.nasdaq.com/api/calendar/{}?date={:%F}",
+                         event_type, date),
+      .header = {{"User-Agent", "Mozilla/5.0"}},
+  };
+}
+
+inline auto read_nasdaq_events(auto& event_type,
+                               auto& date,
+                               const cpr::Response& r) {
+  EventsMap events;
 
   if (r.status_code != 200) {
     std::cerr << std::format("Failed to fetch {} for {}: HTTP {}\n",  //
@@ -114,15 +121,27 @@ EventsMap Calendar::fetch_events(const Symbols& symbols,
   for (auto& si : symbols.arr)
     watchlist.insert(si.symbol);
 
+  // every date and event type, a few at a time so a month of dates doesn't
+  // open a hundred connections to nasdaq at once
+  constexpr const char* event_types[] = {"earnings", "dividends", "splits"};
+  std::vector<std::pair<std::string, LocalTimePoint>> keys;
+  std::vector<http::Request> reqs;
   for (auto date = from; date <= to; date += days{1}) {
-    for (auto& event_type : {"earnings", "dividends", "splits"}) {
-      auto events_map = fetch_nasdaq_events(event_type, date);
-      for (auto& [sym, evs] : events_map) {
-        if (!watchlist.contains(sym))
-          continue;
-        auto& arr = mp[sym];
-        arr.insert(evs.begin(), evs.end());
-      }
+    for (auto event_type : event_types) {
+      keys.emplace_back(event_type, date);
+      reqs.push_back(nasdaq_request(event_type, date));
+    }
+  }
+
+  auto responses = http::get_all(reqs, MAX_IN_FLIGHT);
+  for (size_t i = 0; i < responses.size(); i++) {
+    auto& [event_type, date] = keys[i];
+    auto events_map = read_nasdaq_events(event_type, date, responses[i]);
+    for (auto& [sym, evs] : events_map) {
+      if (!watchlist.contains(sym))
+        continue;
+      auto& arr = mp[sym];
+      arr.insert(evs.begin(), evs.end());
     }
   }
 
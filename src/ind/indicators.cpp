@@ -1,4 +1,5 @@
 #include "ind/indicators.h"
+#include "util/trace.h"
 
 #include <cassert>
 #include <numeric>
@@ -46,6 +47,8 @@ RSI::RSI(const std::vector<Candle>& candles, int period) noexcept
   if (candles.size() < size_t(period + 1))
     return;
 
+  auto& [last_price, avg_gain, avg_loss] = state;
+
   values.reserve(candles.size());
   last_price = candles[0].price();
   values.push_back(
@@ -68,9 +71,13 @@ RSI::RSI(const std::vector<Candle>& candles, int period) noexcept
   double rs = avg_loss == 0.0 ? std::numeric_limits<double>::infinity()
                               : avg_gain / avg_loss;
   values.back() = 100.0 - (100.0 / (1.0 + rs));
+  before = state;
 
-  // continue applying smoothing to the rest of the series
+  // continue applying smoothing to the rest of the series. before trails
+  // state by one candle, so a pop_back right after construction can redo
+  // the last one
   for (size_t i = period + 1; i < candles.size(); ++i) {
+    before = state;
     double change = candles[i].price() - candles[i - 1].price();
     double gain = change > 0 ? change : 0.0;
     double loss = change < 0 ? -change : 0.0;
@@ -86,6 +93,9 @@ RSI::RSI(const std::vector<Candle>& candles, int period) noexcept
 }
 
 void RSI::push_back(const Candle& candle) noexcept {
+  before = state;
+  auto& [last_price, avg_gain, avg_loss] = state;
+
   double change = candle.price() - last_price;
   last_price = candle.price();
 
@@ -180,16 +190,21 @@ void ATR::push_back(const Candle& candle) noexcept {
 }
 
 void Indicators::push_back(const Candle& candle) noexcept {
-  candles.push_back(candle);
-
-  _ema9.push_back(candle);
-  _ema21.push_back(candle);
-  _ema50.push_back(candle);
-  _rsi.push_back(candle);
-  _macd.push_back(candle);
-  _atr.push_back(candle);
+  {
+    Span _{"indicators"};
+    candles.push_back(candle);
+
+    _ema9.push_back(candle);
+    _ema21.push_back(candle);
+    _ema50.push_back(candle);
+    _rsi.push_back(candle);
+    _macd.push_back(candle);
+    _atr.push_back(candle);
+  }
 
   trends = Trends{*this};
+
+  Span _{"signal"};
   signal = Signal{*this};
 }
 
@@ -1,6 +1,7 @@
 #include "core/positions.h"
 #include "ind/indicators.h"
 #include "util/times.h"
+#include "util/trace.h"
 
 #include <spdlog/spdlog.h>
 
@@ -24,6 +25,7 @@ inline Candle combine(auto start, auto end) {
 }
 
 inline auto downsample(auto& candles, minutes source, minutes target) {
+  Span _{"resample"};
   std::vector<Candle> out;
 
   if (candles.empty())
@@ -128,7 +130,12 @@ bool Metrics::push_back(const Candle& candle, const Position* pos) noexcept {
     if (!new_candle)
       ind.pop_back();
 
-    ind.push_back(latest_candle(candles, interval, ind.interval));
+    Candle latest;
+    {
+      Span _{"resample"};
+      latest = latest_candle(candles, interval, ind.interval);
+    }
+    ind.push_back(latest);
     return new_candle;
   };
 
@@ -139,25 +146,3 @@ bool Metrics::push_back(const Candle& candle, const Position* pos) noexcept {
   update_position(pos);
   return new_candle;
 }
-
-void Metrics::rollback() noexcept {
-  auto candle = candles.back();
-  candles.pop_back();
-
-  auto pop_from_ind = [&](auto& ind) {
-    auto prev_time = ind.candles.back().time();
-    auto curr_time = candle.time();
-
-    bool complete_pop = prev_time == curr_time;
-    ind.pop_back();
-
-    if (complete_pop)
-      return;
-
-    ind.push_back(latest_candle(candles, interval, ind.interval));
-  };
-
-  pop_from_ind(ind_1h);
-  pop_from_ind(ind_4h);
-  pop_from_ind(ind_1d);
-}
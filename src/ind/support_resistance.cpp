@@ -1,6 +1,7 @@
 #include "ind/support_resistance.h"
 #include "ind/indicators.h"
 #include "util/config.h"
+#include "util/trace.h"
 
 #include <algorithm>
 #include <cmath>
@@ -290,8 +291,10 @@ inline auto find_zones(auto& ind) {
 }
 
 template <SR sr>
-SupportResistance<sr>::SupportResistance(const IndicatorsCore& ind) noexcept
-    : zones{find_zones<sr>(ind)} {}
+SupportResistance<sr>::SupportResistance(const IndicatorsCore& ind) noexcept {
+  Span _{"sr"};
+  zones = find_zones<sr>(ind);
+}
 
 template <SR sr>
 ZoneOpt SupportResistance<sr>::nearest(double price, bool below) const {
@@ -2,6 +2,7 @@
 #include "ind/indicators.h"
 #include "sig/signals.h"
 #include "util/config.h"
+#include "util/trace.h"
 
 #include <cmath>
 
@@ -133,7 +134,9 @@ TrendLines Trends::ema21_trends(const IndicatorsCore& ind,
       ind_config.n_top_trends);
 }
 
-Trends::Trends(const IndicatorsCore& ind, int last_idx) noexcept
-    : price{price_trends(ind, last_idx)},
-      ema21{ema21_trends(ind, last_idx)},
-      rsi{rsi_trends(ind, last_idx)} {}
+Trends::Trends(const IndicatorsCore& ind, int last_idx) noexcept {
+  Span _{"trends"};
+  price = price_trends(ind, last_idx);
+  ema21 = ema21_trends(ind, last_idx);
+  rsi = rsi_trends(ind, last_idx);
+}
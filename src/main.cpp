@@ -1,6 +1,11 @@
 #include "core/portfolio.h"
+#include "core/simulator.h"
+#include "core/sweep.h"
 #include "mt/endpoints.h"
+#include "mt/metrics_server.h"
+#include "sig/rule_profile.h"
 #include "util/config.h"
+#include "util/trace.h"
 
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/spdlog.h>
@@ -40,12 +45,68 @@ inline void ensure_directories_exist(const std::vector<std::string>& dirs) {
   }
 }
 
+// runs over the dataset a replay left behind, without any of the endpoints
+inline int simulate() {
+  ReplayStore store{replay_fname};
+  if (store.empty() || store.find("SPY") == nullptr) {
+    std::cerr << "[sim] no replay data, run with --replay first" << std::endl;
+    return 1;
+  }
+
+  Timer timer;
+  Simulator sim{Symbols{}, store, config.risk_config.capital_usd(),
+                config.warmup};
+  auto res = sim.run();
+
+  res.write_csv();
+  res.report(timer.diff_s());
+  return 0;
+}
+
+inline int sweep() {
+  ReplayStore store{replay_fname};
+  if (store.empty()) {
+    std::cerr << "[sweep] no replay data, run with --replay first" << std::endl;
+    return 1;
+  }
+
+  auto spec = SweepSpec::read(config.sweep_spec);
+  if (!spec)
+    return 1;
+
+  auto trials = sweep_trials(*spec, config.sig_config, config.risk_config);
+  if (trials.empty())
+    return 1;
+
+  Timer timer;
+  Sweep sw{Symbols{}, store, config.warmup};
+  auto shared_s = timer.diff_s();
+
+  auto results = sw.run(trials);
+  std::cout << std::format("[sweep] {} configs, shared work {:.2f}s, total "
+                           "{:.2f}s",
+                           trials.size(), shared_s, timer.diff_s())
+            << std::endl;
+
+  report_sweep(trials, std::move(results));
+  return 0;
+}
+
 int main(int argc, char* argv[]) {
   ensure_directories_exist({"page", "page/src", "page/backup", "logs", "data"});
   config.read_args(argc, argv);
   init_logging();
+  tracer.enable(config.trace_en);
+  rule_profiler.enable(config.profile_rules);
+  alloc_stats.enable(config.alloc_report);
+
+  if (config.simulate_en)
+    return simulate();
+  if (!config.sweep_spec.empty())
+    return sweep();
 
   {
+    MetricsServer metrics{config.metrics_addr};
     TGEndpoint tg;
     NPMEndpoint npm;
     CloudflareEndpoint cfl;
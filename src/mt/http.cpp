@@ -0,0 +1,51 @@
+#include "mt/http.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace http {
+
+inline auto session(const Request& req) {
+  auto s = std::make_shared<cpr::Session>();
+  s->SetUrl(cpr::Url{req.url});
+  s->SetParameters(req.params);
+  s->SetHeader(req.header);
+  return s;
+}
+
+cpr::Response get(const Request& req) {
+  return session(req)->Get();
+}
+
+std::vector<cpr::Response> get_all(const std::vector<Request>& reqs,
+                                   size_t max_in_flight) {
+  if (reqs.empty())
+    return {};
+  if (reqs.size() == 1)
+    return {get(reqs.front())};
+
+  // one window after the other, each waits for its slowest response
+  std::vector<cpr::Response> res;
+  res.reserve(reqs.size());
+  auto window = std::max<size_t>(max_in_flight, 1);
+  for (size_t i = 0; i < reqs.size(); i += window) {
+    auto end = std::min(reqs.size(), i + window);
+    if (end - i == 1) {
+      res.push_back(get(reqs[i]));
+      continue;
+    }
+
+    cpr::MultiPerform multi;
+    for (auto j = i; j < end; j++)
+      multi.AddSession(session(reqs[j]));
+    for (auto& r : multi.Get())
+      res.push_back(std::move(r));
+  }
+  return res;
+}
+
+cpr::AsyncResponse post_async(const std::string& url, cpr::Payload payload) {
+  return cpr::PostAsync(cpr::Url{url}, std::move(payload));
+}
+
+}  // namespace http
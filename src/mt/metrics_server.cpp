@@ -0,0 +1,141 @@
+#include "mt/metrics_server.h"
+#include "mt/sleeper.h"
+#include "util/telemetry.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+inline bool is_port(const std::string& addr) {
+  return !addr.empty() && std::all_of(addr.begin(), addr.end(), ::isdigit);
+}
+
+inline int listen_tcp(int port) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd == -1)
+    return -1;
+
+  int on = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  sockaddr_in sa{};
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(static_cast<uint16_t>(port));
+  sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) == -1 ||
+      ::listen(fd, 8) == -1) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+inline int listen_unix(const std::string& path) {
+  sockaddr_un sa{};
+  if (path.size() >= sizeof(sa.sun_path))
+    return -1;
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1)
+    return -1;
+
+  sa.sun_family = AF_UNIX;
+  std::memcpy(sa.sun_path, path.data(), path.size());
+  ::unlink(path.c_str());
+
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) == -1 ||
+      ::listen(fd, 8) == -1) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+MetricsServer::MetricsServer(const std::string& addr) noexcept {
+  if (addr.empty())
+    return;
+
+  if (is_port(addr)) {
+    fd = listen_tcp(std::stoi(addr));
+  } else {
+    fd = listen_unix(addr);
+    socket_path = addr;
+  }
+
+  if (fd == -1) {
+    spdlog::error("[metrics] can't listen on {}: {}", addr.c_str(),
+                  std::strerror(errno));
+    socket_path.clear();
+    return;
+  }
+
+  t = std::thread{[this] { serve(); }};
+  spdlog::info("[metrics] serving on {}", addr.c_str());
+}
+
+// one scrape at a time is plenty for a local scraper
+void MetricsServer::serve() {
+  pollfd pfd{.fd = fd, .events = POLLIN, .revents = 0};
+  while (!stopped && !sleeper.should_shutdown()) {
+    if (::poll(&pfd, 1, 500) <= 0)
+      continue;
+
+    int client = ::accept(fd, nullptr, nullptr);
+    if (client == -1)
+      continue;
+
+    respond(client);
+    ::close(client);
+  }
+}
+
+void MetricsServer::respond(int client) {
+  // the request line is all that matters, the rest of the headers are read
+  // and dropped
+  char buf[1024];
+  pollfd pfd{.fd = client, .events = POLLIN, .revents = 0};
+  if (::poll(&pfd, 1, 1000) <= 0)
+    return;
+  auto n = ::recv(client, buf, sizeof(buf) - 1, 0);
+  if (n <= 0)
+    return;
+  buf[n] = '\0';
+
+  std::string_view req{buf, static_cast<size_t>(n)};
+  bool found = req.starts_with("GET /metrics ") || req.starts_with("GET / ");
+
+  auto body = found ? telemetry.expose() : std::string{"not found\n"};
+  auto res = std::format(
+      "HTTP/1.1 {}\r\n"
+      "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+      "Content-Length: {}\r\n"
+      "Connection: close\r\n\r\n{}",
+      found ? "200 OK" : "404 Not Found", body.size(), body);
+
+  for (size_t off = 0; off < res.size();) {
+    auto sent = ::send(client, res.data() + off, res.size() - off,
+                       MSG_NOSIGNAL);
+    if (sent <= 0)
+      return;
+    off += sent;
+  }
+}
+
+MetricsServer::~MetricsServer() noexcept {
+  stopped = true;
+  if (t.joinable())
+    t.join();
+  if (fd != -1)
+    ::close(fd);
+  if (!socket_path.empty())
+    ::unlink(socket_path.c_str());
+}
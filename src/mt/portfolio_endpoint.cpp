@@ -60,7 +60,7 @@ inline void Portfolio::handle_command(const Message& msg) {
 
   if (command == "ping") {
     auto str = std::format("```json\nping: \"{}\"\nlast updated: \"{}\"```",  //
-                           now_ny_time(), last_updated);
+                           wall_ny_time(), last_updated);
     send_to_broker(TG_ID, "send", {{"str", str}});
     return;
   }
@@ -1,19 +1,19 @@
+#include "core/candle_cache.h"
 #include "ind/candle.h"
 #include "mt/api.h"
-#include "mt/sleeper.h"
+#include "mt/http.h"
 #include "util/config.h"
+#include "util/telemetry.h"
 #include "util/times.h"
 
-#include <cpr/cpr.h>
 #include <spdlog/spdlog.h>
 #include <glaze/glaze.hpp>
 
+#include <optional>
 #include <unordered_map>
 
 namespace fs = std::filesystem;
 
-inline constexpr int API_TOKENS = 800;
-inline constexpr int MAX_CALLS_MIN = 8;
 inline auto N_APIs = config.api_config.td_api_keys.size();
 
 inline constexpr minutes get_interval(size_t n_tickers) {
@@ -26,54 +26,39 @@ inline constexpr minutes get_interval(size_t n_tickers) {
   return D_1;
 }
 
-TD::TD(size_t n_tickers) : interval{get_interval(n_tickers)} {
-  for (auto key : config.api_config.td_api_keys)
-    keys.emplace_back(key);
+TD::TD(size_t n_tickers)
+    : keys{config.api_config.td_api_keys},
+      limiter{keys.size(), API_TOKENS},
+      interval{get_interval(n_tickers)} {
   spdlog::info("[td] initiated with {} api keys", keys.size());
 }
 
-int TD::try_get_key() {
-  TimePoint now = Clock::now();
-
-  for (size_t i = 0; i < keys.size(); i++) {
-    auto k = idx;
-    idx = (idx + 1) % keys.size();
-
-    auto& api_key = keys[k];
-    if (api_key.daily_calls >= API_TOKENS)
-      continue;
-
-    auto& timestamps = api_key.call_timestamps;
-    while (!timestamps.empty()) {
-      auto duration = now - timestamps.front();
-      if (duration < minutes(1))
-        break;
-
-      timestamps.pop_front();
-    }
-
-    if (timestamps.size() < MAX_CALLS_MIN)
-      return k;
+// a batch request of n symbols costs n credits against the same key
+std::string TD::get_key(int credits, Deadline deadline) {
+  Timer timer;
+  auto k = limiter.acquire(credits, deadline);
+  if (k == -1) {
+    telemetry
+        .counter("fin_td_throttled_total",
+                 "Calls given up while waiting for credits")
+        .inc();
+    return "";
   }
 
-  return -1;
+  Labels key{{"key", std::to_string(k)}};
+  telemetry
+      .histogram("fin_td_throttle_wait_ms", "Wait for credits per key", key)
+      .observe(timer.diff_ms());
+  telemetry.counter("fin_td_calls_total", "Api calls per key", key).inc();
+  telemetry.counter("fin_td_credits_total", "Credits spent per key", key)
+      .inc(credits);
+  telemetry.gauge("fin_td_credits_remaining", "Credits left today")
+      .set(limiter.remaining_today());
+  return keys[k];
 }
 
-std::string TD::get_key() {
-  auto _ = std::lock_guard{mtx};
-
-  int k = -1;
-  while ((k = try_get_key()) == -1) {
-    auto slept = sleeper.sleep_for(seconds(30));
-    if (!slept)
-      return "";
-  }
-
-  auto& api_key = keys[k];
-  api_key.daily_calls++;
-  api_key.call_timestamps.push_back(Clock::now());
-
-  return api_key.key;
+size_t TD::remaining_calls() {
+  return limiter.remaining_today();
 }
 
 inline std::string interval_to_str(minutes interval) {
@@ -89,28 +74,43 @@ inline std::string interval_to_str(minutes interval) {
 }
 
 TimeSeriesRes read_candles_json(const std::string& str);
+std::unordered_map<std::string, TimeSeriesRes> read_batch_json(
+    const std::string& str);
 
-TimeSeriesRes TD::api_call(const std::string& symbol,
-                           minutes timeframe,
-                           size_t output_size) {
-  auto api_key = get_key();
+inline auto& TD_URL = config.api_config.td_url;
+
+std::optional<http::Request> TD::request(const std::string& symbols,
+                                         int credits,
+                                         minutes timeframe,
+                                         size_t output_size,
+                                         Deadline deadline) {
+  auto api_key = get_key(credits, deadline);
   if (api_key == "")
-    return {};
+    return std::nullopt;
 
   if (output_size > MAX_OUTPUT_SIZE)
     spdlog::error("[td] outputsize exceeds limit");
 
-  cpr::Parameters params{{"symbol", symbol},
-                         {"interval", interval_to_str(timeframe)},
-                         {"outputsize", std::to_string(output_size)},
-                         {"order", "asc"},
-                         {"apikey", api_key}};
+  return http::Request{
+      .url = TD_URL + "/time_series",
+      .params = {{"symbol", symbols},
+                 {"interval", interval_to_str(timeframe)},
+                 {"outputsize", std::to_string(output_size)},
+                 {"order", "asc"},
+                 {"apikey", api_key}},
+  };
+}
 
-  auto res =
-      cpr::Get(cpr::Url{"https://api.twelvedata.com/time_series"}, params);
+TimeSeriesRes TD::api_call(const std::string& symbol,
+                           minutes timeframe,
+                           size_t output_size,
+                           Deadline deadline) {
+  auto req = request(symbol, 1, timeframe, output_size, deadline);
+  if (!req)
+    return {};
 
-  auto slept = sleeper.sleep_for(milliseconds(1500));
-  if (!slept || res.status_code != 200) {
+  auto res = http::get(*req);
+  if (res.status_code != 200) {
     spdlog::error("[td] ({}) time_series http error {}",  //
                   symbol.c_str(), res.status_code);
     return {};
@@ -119,11 +119,126 @@ TimeSeriesRes TD::api_call(const std::string& symbol,
   return read_candles_json(res.text);
 }
 
+// one request per MAX_CALLS_MIN symbols, as a key can't spend more credits
+// than that in a minute, all of them in flight together. symbols that errored
+// inside an otherwise valid response are retried on their own; a failed
+// request is left for the next cycle.
+std::unordered_map<std::string, TimeSeriesRes> TD::batch_call(
+    const std::vector<std::string>& symbols,
+    minutes timeframe,
+    size_t output_size,
+    Deadline deadline) {
+  std::unordered_map<std::string, TimeSeriesRes> res;
+
+  std::vector<std::vector<std::string>> groups;
+  std::vector<http::Request> reqs;
+  for (size_t i = 0; i < symbols.size(); i += MAX_CALLS_MIN) {
+    auto end = std::min(symbols.size(), i + MAX_CALLS_MIN);
+
+    auto joined = symbols[i];
+    for (size_t j = i + 1; j < end; j++)
+      joined += "," + symbols[j];
+
+    auto credits = static_cast<int>(end - i);
+    auto req = request(joined, credits, timeframe, output_size, deadline);
+    if (!req)
+      break;
+
+    groups.emplace_back(symbols.begin() + i, symbols.begin() + end);
+    reqs.push_back(std::move(*req));
+  }
+
+  if (reqs.empty())
+    return res;
+
+  auto responses = http::get_all(reqs);
+
+  std::vector<std::string> retry;
+  for (size_t i = 0; i < responses.size(); i++) {
+    auto& r = responses[i];
+    auto& group = groups[i];
+    if (r.status_code != 200) {
+      spdlog::error("[td] ({}...) time_series http error {}",
+                    group.front().c_str(), r.status_code);
+      continue;
+    }
+
+    // single symbol responses aren't keyed by symbol
+    if (group.size() == 1) {
+      auto candles = read_candles_json(r.text);
+      if (!candles.empty())
+        res.try_emplace(group.front(), std::move(candles));
+      continue;
+    }
+
+    auto batch = read_batch_json(r.text);
+    if (batch.empty())
+      continue;
+
+    for (auto& symbol : group) {
+      auto it = batch.find(symbol);
+      if (it != batch.end() && !it->second.empty())
+        res.try_emplace(symbol, std::move(it->second));
+      else
+        retry.push_back(symbol);
+    }
+  }
+
+  for (auto& symbol : retry) {
+    spdlog::warn("[td] ({}) missing from batch, retrying", symbol.c_str());
+    auto candles = api_call(symbol, timeframe, output_size, deadline);
+    if (!candles.empty())
+      res.try_emplace(symbol, std::move(candles));
+  }
+
+  return res;
+}
+
+// candles since `last`, overestimated by counting wall time. outputsize
+// doesn't change the credit cost of a call.
+inline size_t delta_size(LocalTimePoint last, minutes timeframe) {
+  auto elapsed = std::max(now_ny_time() - last, LocalTimePoint::duration{0});
+  auto n = static_cast<size_t>(elapsed / timeframe) + 2;
+  return std::min<size_t>(n, MAX_OUTPUT_SIZE);
+}
+
+// cached candles topped up with the ones after the last stored. a cold
+// cache, or a delta that doesn't reach back to it, is a full fetch.
 TimeSeriesRes TD::time_series(const std::string& symbol,
                               minutes timeframe) noexcept {
   TimeSeriesRes res;
   try {
+    CandleCache cache{symbol, timeframe};
+    res = cache.read(MAX_OUTPUT_SIZE);
+
+    auto n = res.empty() ? MAX_OUTPUT_SIZE
+                         : delta_size(res.back().time(), timeframe);
+    if (n < MAX_OUTPUT_SIZE) {
+      auto fresh = api_call(symbol, timeframe, n);
+      if (fresh.empty())
+        return res;
+
+      if (fresh.front().time() <= res.back().time()) {
+        std::erase_if(res, [&](auto& c) {
+          return c.time() >= fresh.front().time();
+        });
+        res.insert(res.end(), fresh.begin(), fresh.end());
+        if (res.size() > MAX_OUTPUT_SIZE)
+          res.erase(res.begin(), res.end() - MAX_OUTPUT_SIZE);
+
+        cache.merge(fresh);
+        spdlog::info("[ts] ({}) {} candles from cache, {} fetched",
+                     symbol.c_str(), res.size() - fresh.size(), fresh.size());
+        return res;
+      }
+
+      spdlog::warn("[ts] ({}) gap after the cache, refetching",
+                   symbol.c_str());
+    }
+
     res = api_call(symbol, timeframe);
+    if (!res.empty())
+      cache.write(res);
   } catch (const std::exception& ex) {
     spdlog::error("[ts] ({}) error: {}", symbol.c_str(), ex.what());
   }
@@ -131,10 +246,11 @@ TimeSeriesRes TD::time_series(const std::string& symbol,
 }
 
 RealTimeRes TD::real_time(const std::string& symbol,
-                          minutes timeframe) noexcept {
+                          minutes timeframe,
+                          Deadline deadline) noexcept {
   RealTimeRes res;
   try {
-    auto candles = api_call(symbol, timeframe, 2);
+    auto candles = api_call(symbol, timeframe, 2, deadline);
     if (!candles.empty())
       res = {candles[candles.size() - 2], candles[candles.size() - 1]};
   } catch (const std::exception& ex) {
@@ -143,6 +259,103 @@ RealTimeRes TD::real_time(const std::string& symbol,
   return res;
 }
 
+RealTimeBatch TD::real_time(const std::vector<std::string>& symbols,
+                            minutes timeframe,
+                            Deadline deadline) noexcept {
+  RealTimeBatch res;
+  try {
+    for (auto& [symbol, candles] : batch_call(symbols, timeframe, 2, deadline))
+      if (candles.size() >= 2)
+        res.try_emplace(symbol, candles[candles.size() - 2], candles.back());
+  } catch (const std::exception& ex) {
+    spdlog::error("[rt] batch error: {}", ex.what());
+  }
+  return res;
+}
+
+double read_price_json(const std::string& str);
+
+// the /price endpoint costs a single credit and returns only the last trade
+double TD::price(const std::string& symbol) noexcept {
+  try {
+    auto api_key = get_key();
+    if (api_key == "")
+      return 0.0;
+
+    auto res = http::get({
+        .url = TD_URL + "/price",
+        .params = {{"symbol", symbol}, {"apikey", api_key}},
+    });
+    if (res.status_code != 200) {
+      spdlog::error("[td] ({}) price http error {}", symbol.c_str(),
+                    res.status_code);
+      return 0.0;
+    }
+
+    return read_price_json(res.text);
+  } catch (const std::exception& ex) {
+    spdlog::error("[price] ({}) error: {}", symbol.c_str(), ex.what());
+  }
+  return 0.0;
+}
+
+std::unordered_map<std::string, double> read_prices_json(
+    const std::string& str);
+
+// the last trade of every symbol, a credit each, in one request per
+// MAX_CALLS_MIN symbols like batch_call
+std::unordered_map<std::string, double> TD::prices(
+    const std::vector<std::string>& symbols) noexcept {
+  std::unordered_map<std::string, double> res;
+  try {
+    std::vector<std::vector<std::string>> groups;
+    std::vector<http::Request> reqs;
+    for (size_t i = 0; i < symbols.size(); i += MAX_CALLS_MIN) {
+      auto end = std::min(symbols.size(), i + MAX_CALLS_MIN);
+
+      auto joined = symbols[i];
+      for (size_t j = i + 1; j < end; j++)
+        joined += "," + symbols[j];
+
+      auto api_key = get_key(static_cast<int>(end - i));
+      if (api_key == "")
+        break;
+
+      groups.emplace_back(symbols.begin() + i, symbols.begin() + end);
+      reqs.push_back(http::Request{
+          .url = TD_URL + "/price",
+          .params = {{"symbol", joined}, {"apikey", api_key}},
+      });
+    }
+
+    if (reqs.empty())
+      return res;
+
+    auto responses = http::get_all(reqs);
+    for (size_t i = 0; i < responses.size(); i++) {
+      auto& r = responses[i];
+      auto& group = groups[i];
+      if (r.status_code != 200) {
+        spdlog::error("[td] ({}...) price http error {}",
+                      group.front().c_str(), r.status_code);
+        continue;
+      }
+
+      // single symbol responses aren't keyed by symbol
+      if (group.size() == 1) {
+        if (auto px = read_price_json(r.text); px > 0.0)
+          res.try_emplace(group.front(), px);
+        continue;
+      }
+
+      res.merge(read_prices_json(r.text));
+    }
+  } catch (const std::exception& ex) {
+    spdlog::error("[prices] error: {}", ex.what());
+  }
+  return res;
+}
+
 LocalTimePoint TD::latest_datetime() noexcept {
   LocalTimePoint tp;
   try {
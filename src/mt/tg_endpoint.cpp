@@ -1,29 +1,39 @@
 #include "mt/endpoints.h"
+#include "mt/http.h"
 #include "util/config.h"
+#include "util/telemetry.h"
 
 #include <cpr/cpr.h>
 #include <spdlog/spdlog.h>
 #include <nlohmann/json.hpp>
 
 #include <format>
+#include <optional>
 
 using nlohmann::json;
 
+inline auto& TG_URL = config.api_config.tg_url;
 inline auto& TG_TOKEN = config.api_config.tg_token;
 inline auto& TG_CHAT_ID = config.api_config.tg_chat_id;
 inline auto& TG_USER = config.api_config.tg_user;
 
-inline int send_str(const std::string& text) {
+// the post completes on cpr's async pool, see sent_id
+inline std::optional<cpr::AsyncResponse> send_str(const std::string& text) {
   spdlog::debug("[tg] send: {}...", text.substr(0, 20).c_str());
   if (!config.tg_en || text == "")
-    return -1;
+    return std::nullopt;
+
+  auto url = std::format("{}/bot{}/sendMessage", TG_URL, TG_TOKEN);
+  return http::post_async(url,
+                          cpr::Payload{{"chat_id", std::string(TG_CHAT_ID)},
+                                       {"text", text},
+                                       {"parse_mode", "Markdown"}});
+}
 
-  auto url =
-      std::format("https://api.telegram.org/bot{}/sendMessage", TG_TOKEN);
-  auto r = cpr::Post(cpr::Url{url},
-                     cpr::Payload{{"chat_id", std::string(TG_CHAT_ID)},
-                                  {"text", text},
-                                  {"parse_mode", "Markdown"}});
+inline int sent_id(const cpr::Response& r) {
+  static auto& rtt = telemetry.histogram("fin_tg_rtt_ms",
+                                         "Round trip of a telegram send");
+  rtt.observe(r.elapsed * 1000);
 
   if (r.status_code != 200 || r.text == "") {
     spdlog::error("[tg] error {}: {}", r.status_code, r.text.c_str());
@@ -39,8 +49,7 @@ inline void pin_message(int message_id) {
   if (!config.tg_en)
     return;
 
-  auto url =
-      std::format("https://api.telegram.org/bot{}/pinChatMessage", TG_TOKEN);
+  auto url = std::format("{}/bot{}/pinChatMessage", TG_URL, TG_TOKEN);
   cpr::Response r = cpr::Post(
       cpr::Url{url}, cpr::Payload{{"chat_id", std::string(TG_CHAT_ID)},
                                   {"message_id", std::to_string(message_id)},
@@ -63,9 +72,8 @@ inline std::tuple<bool, std::string, int> listen(int last_update_id) {
   if (!config.tg_en)
     return {false, "", -1};
 
-  auto url =
-      std::format("https://api.telegram.org/bot{}/getUpdates?offset={}&limit=1",
-                  TG_TOKEN, last_update_id + 1);
+  auto url = std::format("{}/bot{}/getUpdates?offset={}&limit=1", TG_URL,
+                         TG_TOKEN, last_update_id + 1);
   auto r = cpr::Get(cpr::Url{url});
 
   if (r.status_code != 200) {
@@ -101,8 +109,7 @@ inline void delete_msg(int message_id) {
   if (!config.tg_en)
     return;
 
-  auto url =
-      std::format("https://api.telegram.org/bot{}/deleteMessage", TG_TOKEN);
+  auto url = std::format("{}/bot{}/deleteMessage", TG_URL, TG_TOKEN);
 
   cpr::Response r = cpr::Post(
       cpr::Url{url}, cpr::Payload{{"chat_id", TG_CHAT_ID},
@@ -120,8 +127,7 @@ inline int send_doc(const std::string& fname,
   if (!config.tg_en)
     return -1;
 
-  auto url =
-      std::format("https://api.telegram.org/bot{}/sendDocument", TG_TOKEN);
+  auto url = std::format("{}/bot{}/sendDocument", TG_URL, TG_TOKEN);
 
   cpr::Multipart multipart{
       {"chat_id", TG_CHAT_ID},
@@ -177,7 +183,21 @@ void TGEndpoint::t_receive_f() {
   }
 }
 
+// a send is in flight while the next message is popped. it's collected
+// before the next post so messages keep their order.
 void TGEndpoint::t_send_f() {
+  std::optional<cpr::AsyncResponse> inflight;
+  auto collect = [&] {
+    if (!inflight)
+      return;
+    try {
+      sent_id(inflight->get());
+    } catch (const std::exception& ex) {
+      spdlog::error("[tg] send error: {}", ex.what());
+    }
+    inflight.reset();
+  };
+
   while (!is_stopped()) {
     auto msg_opt = msg_q.pop();
     if (!msg_opt)
@@ -186,10 +206,14 @@ void TGEndpoint::t_send_f() {
     auto msg = *msg_opt;
     if (msg.cmd == "send") {
       auto it = msg.params.find("str");
-      if (it != msg.params.end())
-        send_str(it->second);
+      if (it != msg.params.end()) {
+        collect();
+        inflight = send_str(it->second);
+      }
     }
   }
+
+  collect();
 }
 
 TGEndpoint::TGEndpoint() noexcept : Endpoint{TG_ID} {
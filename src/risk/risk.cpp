@@ -2,6 +2,7 @@
 #include "ind/calendar.h"
 #include "util/config.h"
 #include "util/format.h"
+#include "util/trace.h"
 
 inline auto& risk_config = config.risk_config;
 
@@ -19,18 +20,17 @@ Risk::Risk(const Metrics& m,
            const CombinedSignal& signal,
            const OpenPositions& positions,
            const Event& next_event) noexcept {
-  std::vector<fmt_string> checks;
-  std::vector<fmt_string> decision;
+  Span _{"risk"};
+  auto& r = overall_rationale;
+  r.notes.reserve(10);
 
   auto spy_idx = spy.idx_for_time(tp);
   regime = detect_market_regime(spy, spy_idx);
-  checks.emplace_back("{} market", tagged(regime, color_of(regime), BOLD));
+  r.add(Part::Detail, RiskWhy::Market, regime);
 
   is_near_earnings = check_earnings_proximity(next_event);
   if (is_near_earnings) {
-    checks.emplace_back(
-        "{} days until earnings",
-        tagged(next_event.days_until(), color_of("semi-bad"), BOLD));
+    r.add(Part::Detail, RiskWhy::Earnings, next_event.days_until());
     should_take_trade = false;
   }
 
@@ -45,30 +45,80 @@ Risk::Risk(const Metrics& m,
                       regime != MarketRegime::TRENDING_DOWN;
 
   if (should_take_trade) {
-    decision.emplace_back(tagged("TAKE TRADE", color_of("wishful"), BOLD));
+    r.add(Part::Reason, RiskWhy::Take);
   } else {
-    decision.emplace_back(tagged("SKIP", color_of("semi-bad"), BOLD));
+    r.add(Part::Reason, RiskWhy::Skip);
 
     if (is_near_earnings)
-      decision.emplace_back(tagged("Earnings too close", color_of("semi-bad")));
+      r.add(Part::Reason, RiskWhy::EarningsClose);
     if (sizing.rec == Recommendation::Avoid)
-      decision.emplace_back(tagged("Position sizing rejected"),
-                            color_of("caution"));
+      r.add(Part::Reason, RiskWhy::SizingRejected);
     if (target.risk_reward_ratio < risk_config.min_rr_ratio)
-      decision.emplace_back("R:R too low ({:.1f})", target.risk_reward_ratio);
+      r.add(Part::Reason, RiskWhy::RRTooLow, target.risk_reward_ratio);
     if (regime == MarketRegime::TRENDING_DOWN)
-      decision.emplace_back(
-          tagged("Market trending down", color_of("bad"), IT));
+      r.add(Part::Reason, RiskWhy::TrendingDown);
   }
 
-  checks.emplace_back("Stop: {:.2f} (-{:.1f}%)", stop_loss.get_stop_price(),
-                      stop_loss.get_stop_percentage(m.last_price()) * 100);
-  checks.emplace_back("Risk: {}%",
-                      tagged(sizing.position_risk_pct * 100, color_of("risk")));
-  checks.emplace_back("Target: {:.2f} ({:.1f}:1)", target.target_price,
-                      target.risk_reward_ratio);
+  r.add(Part::Detail, RiskWhy::Stop, stop_loss.get_stop_price(),
+        stop_loss.get_stop_percentage(m.last_price()) * 100);
+  r.add(Part::Detail, RiskWhy::Risk, sizing.position_risk_pct * 100);
+  r.add(Part::Detail, RiskWhy::Target, target.target_price,
+        target.risk_reward_ratio);
+}
+
+template <FormatTarget target>
+inline std::string note_str(const Rationale<RiskWhy>::Note& n) {
+  auto tag = [](auto&& v, auto... tags) {
+    return tagged_as<target>(v, tags...);
+  };
+
+  switch (n.code) {
+    case RiskWhy::Take:
+      return tag("TAKE TRADE", color_of("wishful"), BOLD);
+    case RiskWhy::Skip:
+      return tag("SKIP", color_of("semi-bad"), BOLD);
+    case RiskWhy::EarningsClose:
+      return tag("Earnings too close", color_of("semi-bad"));
+    case RiskWhy::SizingRejected:
+      return "Position sizing rejected";
+    case RiskWhy::RRTooLow:
+      return std::format("R:R too low ({:.1f})", n[0]);
+    case RiskWhy::TrendingDown:
+      return tag("Market trending down", color_of("bad"), IT);
+
+    case RiskWhy::Market: {
+      auto regime = n.as<MarketRegime>(0);
+      return std::format("{} market", tag(regime, color_of(regime), BOLD));
+    }
+    case RiskWhy::Earnings:
+      return std::format("{} days until earnings",
+                         tag(n.i(0), color_of("semi-bad"), BOLD));
+    case RiskWhy::Stop:
+      return std::format("Stop: {:.2f} (-{:.1f}%)", n[0], n[1]);
+    case RiskWhy::Risk:
+      return std::format("Risk: {}%", tag(n[0], color_of("risk")));
+    case RiskWhy::Target:
+      return std::format("Target: {:.2f} ({:.1f}:1)", n[0], n[1]);
+  }
+  return "";
+}
+
+template <FormatTarget target>
+inline std::string rationale_str(const Risk& risk) {
+  auto& r = risk.overall_rationale;
+  if (r.empty())
+    return "";
+
+  auto decision = r.join(Part::Reason, " | ", note_str<target>);
+  auto checks = r.join(Part::Detail, " | ", note_str<target>);
 
-  constexpr auto rationale_templ = R"(
+  auto stop = to_str<target>(risk.stop_loss.rationale, risk.stop_loss);
+  auto size = to_str<target>(risk.sizing.rationale, risk.sizing);
+  auto profit = to_str<target>(risk.target.rationale, risk.target);
+  auto scale = to_str<target>(risk.scaling.rationale, risk.scaling);
+
+  if constexpr (target == FormatTarget::HTML) {
+    constexpr auto rationale_templ = R"(
       <div class="risk-summary">{}</div>
       <div class="risk-checks rationale-details">{}</div>
       <div class="risk-components">
@@ -81,19 +131,32 @@ Risk::Risk(const Metrics& m,
       </div>
   )";
 
-  overall_rationale = fmt_string{
-      rationale_templ,
-      join(decision.begin(), decision.end(), " | "),  //
-      join(checks.begin(), checks.end(), " | "),      //
-      tagged("Stop", BOLD),                           //
-      stop_loss.rationale,                            //
-      tagged("Size", BOLD),                           //
-      sizing.rationale,                               //
-      tagged("Target", BOLD),                         //
-      target.rationale,                               //
-      tagged("Scale", BOLD),                          //
-      scaling.rationale                               //
-  };
+    return std::format(                  //
+        rationale_templ,                 //
+        decision,                        //
+        checks,                          //
+        tagged("Stop", BOLD), stop,      //
+        tagged("Size", BOLD), size,      //
+        tagged("Target", BOLD), profit,  //
+        tagged("Scale", BOLD), scale     //
+    );
+  } else {
+    return std::format(
+        "{}\n{}\n\nStop: {}\n\nSize: {}\n\nTarget: {}\n\nScale: {}",
+        decision, checks, stop, size, profit, scale);
+  }
+}
+
+template <>
+std::string to_str<FormatTarget::HTML>(const Rationale<RiskWhy>&,
+                                       const Risk& risk) {
+  return rationale_str<FormatTarget::HTML>(risk);
+}
+
+template <>
+std::string to_str<FormatTarget::Telegram>(const Rationale<RiskWhy>&,
+                                           const Risk& risk) {
+  return rationale_str<FormatTarget::Telegram>(risk);
 }
 
 MarketRegime Risk::detect_market_regime(const Indicators& spy, int idx) const {
@@ -15,8 +15,7 @@ ScalingRules::ScalingRules(const Metrics& m,
   double entry_price = pos->px;
   double position_pnl_pct = (current_price - entry_price) / entry_price;
 
-  std::vector<fmt_string> reasons;
-  std::vector<fmt_string> details;
+  auto& r = rationale;
 
   // Scale up rules - add to winners
   if (position_pnl_pct >= 0.05) {  // Up 5%
@@ -38,13 +37,11 @@ ScalingRules::ScalingRules(const Metrics& m,
       add_trigger_price = current_price * 1.01;  // Add on 1% more gain
       add_size_shares = initial_sizing.rec_shares * 0.25;  // Add 25% of initial
 
-      reasons.push_back(std::format(
-          "can add {} shares at {}", tagged(add_size_shares, color_of("good")),
-          tagged(add_trigger_price, color_of("good"))));
+      r.add(Part::Reason, ScalingWhy::CanAdd, add_size_shares,
+            add_trigger_price);
 
       if (breaking_resistance)
-        details.push_back(
-            tagged("breaking resistance", color_of("good"), BOLD));
+        r.add(Part::Detail, ScalingWhy::BreakingResistance);
     }
   }
 
@@ -57,29 +54,75 @@ ScalingRules::ScalingRules(const Metrics& m,
     trim_trigger_price = current_price * 0.99;  // Trim on 1% more loss
     trim_size_shares = pos->qty * 0.5;          // Trim half
 
-    details.push_back(tagged("halfway to stop", color_of("semi-bad"), BOLD));
+    r.add(Part::Detail, ScalingWhy::HalfwayToStop);
 
     // Check if at support - maybe don't trim
     auto idx_1h = m.ind_1h.idx_for_time(tp);
     auto support = m.ind_1h.nearest_support_below(idx_1h);
     if (support && support->get().is_near(current_price)) {
       should_trim = false;
-      details.push_back(
-          tagged("but at support - holding", color_of("wishful")));
+      r.add(Part::Detail, ScalingWhy::AtSupport);
     }
 
     if (should_trim)
-      reasons.emplace_back("should trim {} shares at {}",
-                           tagged(trim_size_shares, color_of("semi-bad")),
-                           tagged(trim_trigger_price, color_of("semi-bad")));
+      r.add(Part::Reason, ScalingWhy::Trim, trim_size_shares,
+            trim_trigger_price);
   }
 
-  if (!can_add && !should_trim) {
-    reasons.push_back(tagged("no scaling action", color_of("comment")));
+  if (!can_add && !should_trim)
+    r.add(Part::Reason, ScalingWhy::NoAction);
+}
+
+template <FormatTarget target>
+inline std::string note_str(const Rationale<ScalingWhy>::Note& n) {
+  auto tag = [](auto&& v, auto... tags) {
+    return tagged_as<target>(v, tags...);
+  };
+
+  switch (n.code) {
+    case ScalingWhy::CanAdd:
+      return std::format("can add {} shares at {}", tag(n[0], color_of("good")),
+                         tag(n[1], color_of("good")));
+    case ScalingWhy::Trim:
+      return std::format("should trim {} shares at {}",
+                         tag(n[0], color_of("semi-bad")),
+                         tag(n[1], color_of("semi-bad")));
+    case ScalingWhy::NoAction:
+      return tag("no scaling action", color_of("comment"));
+    case ScalingWhy::BreakingResistance:
+      return tag("breaking resistance", color_of("good"), BOLD);
+    case ScalingWhy::HalfwayToStop:
+      return tag("halfway to stop", color_of("semi-bad"), BOLD);
+    case ScalingWhy::AtSupport:
+      return tag("but at support - holding", color_of("wishful"));
   }
+  return "";
+}
+
+template <FormatTarget target>
+inline std::string rationale_str(const Rationale<ScalingWhy>& r) {
+  if (r.empty())
+    return "";
+
+  auto sep = tagged_as<target>(" | ", color_of("comment"));
+  auto reasons = r.join(Part::Reason, sep, note_str<target>);
+  auto details = r.join(Part::Detail, sep, note_str<target>);
+
+  if constexpr (target == FormatTarget::HTML)
+    return std::format("{}<br><div class=\"rationale-details\">{}</div>",
+                       reasons, details);
+  else
+    return std::format("{}\n{}", reasons, details);
+}
+
+template <>
+std::string to_str<FormatTarget::HTML>(const Rationale<ScalingWhy>& r,
+                                       const ScalingRules&) {
+  return rationale_str<FormatTarget::HTML>(r);
+}
 
-  rationale = std::format(
-      "{}<br><div class=\"rationale-details\">{}</div>",
-      join(reasons.begin(), reasons.end(), tagged(" | ", color_of("comment"))),
-      join(details.begin(), details.end(), tagged(" | ", color_of("comment"))));
+template <>
+std::string to_str<FormatTarget::Telegram>(const Rationale<ScalingWhy>& r,
+                                           const ScalingRules&) {
+  return rationale_str<FormatTarget::Telegram>(r);
 }
@@ -1,5 +1,6 @@
 #include "risk/sizing.h"
 #include "core/positions.h"
+#include "util/arena.h"
 #include "util/config.h"
 #include "util/format.h"
 #include "util/math.h"
@@ -13,7 +14,7 @@ struct PortfolioState {
   int active_positions = 0;
   double total_risk_deployed = 0.0;
   int positions_opened_today = 0;
-  std::vector<std::string> current_symbols;
+  std::pmr::vector<std::string_view> current_symbols{scratch()};
 
   PortfolioState(const OpenPositions& positions) {
     auto& pos_map = positions.get_positions();
@@ -42,7 +43,7 @@ inline double calculate_correlation_to_spy(const Metrics& m,
   auto& stock_ind = m.ind_1d;
   auto idx = stock_ind.idx_for_time(tp);
 
-  std::vector<double> stock_returns, spy_returns;
+  std::pmr::vector<double> stock_returns{scratch()}, spy_returns{scratch()};
   for (int i = idx - CORRELATION_PERIOD; i < idx; i++) {
     double stock_ret =
         (stock_ind.price(i) - stock_ind.price(i - 1)) / stock_ind.price(i - 1);
@@ -131,10 +132,8 @@ PositionSizing::PositionSizing(  //
     const OpenPositions& positions,
     MarketRegime regime  //
 ) {
-  std::vector<fmt_string> reasons;
-  std::vector<fmt_string> adjustments;
-  std::vector<fmt_string> details;
-  auto sep = tagged(" | ", color_of("comment"));
+  auto& r = rationale;
+  r.notes.reserve(12);
 
   PortfolioState portfolio{positions};
   double current_price = m.last_price();
@@ -150,15 +149,9 @@ PositionSizing::PositionSizing(  //
     hit_daily_limit = true;
     rec = Recommendation::Avoid;
 
-    reasons.emplace_back(tagged("daily limit hit", color_of("bad"), BOLD));
-    details.emplace_back(
-        "{}/{} positions today",
-        tagged(portfolio.positions_opened_today, color_of("bad")),
-        tagged(daily_limit, color_of("comment")));
-
-    rationale = std::format("{}<br><div class=\"rationale-details\">{}</div>",
-                            join(reasons.begin(), reasons.end(), sep),
-                            join(details.begin(), details.end(), sep));
+    r.add(Part::Reason, SizingWhy::DailyLimit);
+    r.add(Part::Detail, SizingWhy::PositionsToday,
+          portfolio.positions_opened_today, daily_limit);
     return;
   }
 
@@ -166,9 +159,8 @@ PositionSizing::PositionSizing(  //
   double target_risk = calculate_target_risk(signal, regime);
   if (target_risk < 0.002) {
     rec = Recommendation::Avoid;
-    reasons.emplace_back(tagged("weak signal", color_of("caution")));
-    details.emplace_back("target risk {}% too low",
-                         tagged(target_risk * 100, color_of("risk")));
+    r.add(Part::Reason, SizingWhy::WeakSignal);
+    r.add(Part::Detail, SizingWhy::TargetRiskLow, target_risk * 100);
   }
 
   // Apply risk adjustments
@@ -178,31 +170,25 @@ PositionSizing::PositionSizing(  //
   if (correlation_to_spy > 0.8) {
     risk_multiplier *= 0.8;
     was_reduced_for_correlation = true;
-    adjustments.emplace_back("high SPY corr {}",
-                             tagged(correlation_to_spy, color_of("semi-bad")));
+    r.add(Part::Adjust, SizingWhy::HighCorr, correlation_to_spy);
   } else if (correlation_to_spy < -0.3) {
     risk_multiplier *= 1.1;  // Defensive hedge bonus
-    adjustments.emplace_back("defensive hedge {}",
-                             tagged(correlation_to_spy, color_of("semi-good")));
+    r.add(Part::Adjust, SizingWhy::Hedge, correlation_to_spy);
   } else {
-    adjustments.emplace_back("spy corr {}",
-                             tagged(correlation_to_spy, color_of("info")));
+    r.add(Part::Adjust, SizingWhy::Corr, correlation_to_spy);
   }
 
   // Volatility adjustment
   if (daily_atr_pct > 0.05) {
     risk_multiplier *= 0.7;
     was_reduced_for_volatility = true;
-    adjustments.emplace_back("high vol {}%",
-                             tagged(daily_atr_pct * 100, color_of("semi-bad")));
+    r.add(Part::Adjust, SizingWhy::HighVol, daily_atr_pct * 100);
   } else if (daily_atr_pct > 0.04) {
     risk_multiplier *= 0.85;
     was_reduced_for_volatility = true;
-    adjustments.emplace_back("elevated vol {}%",
-                             tagged(daily_atr_pct * 100, color_of("caution")));
+    r.add(Part::Adjust, SizingWhy::ElevatedVol, daily_atr_pct * 100);
   } else {
-    adjustments.emplace_back("{}% vol",
-                             tagged(daily_atr_pct * 100, color_of("info")));
+    r.add(Part::Adjust, SizingWhy::Vol, daily_atr_pct * 100);
   }
 
   // Calculate adjusted risk
@@ -216,19 +202,12 @@ PositionSizing::PositionSizing(  //
     if (available_risk > 0.002) {  // At least 0.2% available
       adjusted_risk = available_risk;
       was_reduced_for_portfolio_limit = true;
-      adjustments.emplace_back(
-          "portfolio limit, using {}%",
-          tagged(available_risk * 100, color_of("semi-bad")));
+      r.add(Part::Adjust, SizingWhy::PortfolioLimit, available_risk * 100);
     } else {
       rec = Recommendation::Avoid;
-      reasons.emplace_back(
-          tagged("portfolio risk full", color_of("bad"), BOLD));
-      details.emplace_back(
-          "{}% deployed",
-          tagged(portfolio.total_risk_deployed * 100, color_of("bad")));
-      rationale = std::format("{}<br><div class=\"rationale-details\">{}</div>",
-                              join(reasons.begin(), reasons.end(), sep),
-                              join(details.begin(), details.end(), sep));
+      r.add(Part::Reason, SizingWhy::PortfolioFull);
+      r.add(Part::Detail, SizingWhy::Deployed,
+            portfolio.total_risk_deployed * 100);
       return;
     }
   }
@@ -236,9 +215,7 @@ PositionSizing::PositionSizing(  //
   // Position concentration check
   if (portfolio.active_positions >= 10) {
     risk_multiplier *= 0.8;
-    adjustments.emplace_back(
-        "{} positions open",
-        tagged(portfolio.active_positions, color_of("info")));
+    r.add(Part::Adjust, SizingWhy::PositionsOpen, portfolio.active_positions);
   }
 
   // Calculate final position
@@ -256,54 +233,137 @@ PositionSizing::PositionSizing(  //
   rec = determine_recommendation(position_risk_pct);
 
   // Build rationale
-  auto rec_str = tagged(rec, color_of(rec));
-  if (rec == Recommendation::StrongBuy)
-    rec_str = tagged(rec_str, BOLD);
-
-  reasons.emplace_back(rec_str);
-  reasons.emplace_back("{}% risk",
-                       tagged(position_risk_pct * 100, color_of("risk")));
+  r.add(Part::Reason, SizingWhy::Rec, rec);
+  r.add(Part::Reason, SizingWhy::RiskPct, position_risk_pct * 100);
   if (rec != Recommendation::Avoid)
-    reasons.emplace_back("{} w/ ${}", tagged(rec_shares, color_of("wishful")),
-                         tagged(rec_capital, color_of("wishful")));
+    r.add(Part::Reason, SizingWhy::Shares, rec_shares, rec_capital);
 
   // Stop context
-  details.emplace_back("stop distance ${}",
-                       tagged(stop_distance, color_of("info")));
-  details.emplace_back(
-      "risk per share ${}",
-      tagged(position_risk_amount / rec_shares, color_of("info")));
+  r.add(Part::Detail, SizingWhy::StopDistance, stop_distance);
+  r.add(Part::Detail, SizingWhy::RiskPerShare,
+        position_risk_amount / rec_shares);
 
   // Portfolio context
-  auto portfolio_str =
-      std::format("portfolio: {}/12 positions, {}% -> {}% risk",
-                  tagged(portfolio.active_positions, "frost"),
-                  tagged(portfolio.total_risk_deployed * 100, "frost"),
-                  tagged(portfolio_risk_after * 100, "frost"));
-
-  // Build final rationale
-  if (!adjustments.empty()) {
-    constexpr auto templ = R"(
+  r.add(Part::Context, SizingWhy::Portfolio, portfolio.active_positions,
+        portfolio.total_risk_deployed * 100, portfolio_risk_after * 100);
+}
+
+template <FormatTarget target>
+inline std::string note_str(const Rationale<SizingWhy>::Note& n) {
+  auto tag = [](auto&& v, auto... tags) {
+    return tagged_as<target>(v, tags...);
+  };
+
+  switch (n.code) {
+    case SizingWhy::DailyLimit:
+      return tag("daily limit hit", color_of("bad"), BOLD);
+    case SizingWhy::WeakSignal:
+      return tag("weak signal", color_of("caution"));
+    case SizingWhy::PortfolioFull:
+      return tag("portfolio risk full", color_of("bad"), BOLD);
+    case SizingWhy::Rec: {
+      auto rec = n.as<Recommendation>(0);
+      auto str = tag(rec, color_of(rec));
+      return rec == Recommendation::StrongBuy ? tag(str, BOLD) : str;
+    }
+    case SizingWhy::RiskPct:
+      return std::format("{}% risk", tag(n[0], color_of("risk")));
+    case SizingWhy::Shares:
+      return std::format("{} w/ ${}", tag(n[0], color_of("wishful")),
+                         tag(n[1], color_of("wishful")));
+
+    case SizingWhy::PositionsToday:
+      return std::format("{}/{} positions today", tag(n.i(0), color_of("bad")),
+                         tag(n.i(1), color_of("comment")));
+    case SizingWhy::TargetRiskLow:
+      return std::format("target risk {}% too low",
+                         tag(n[0], color_of("risk")));
+    case SizingWhy::Deployed:
+      return std::format("{}% deployed", tag(n[0], color_of("bad")));
+    case SizingWhy::StopDistance:
+      return std::format("stop distance ${}", tag(n[0], color_of("info")));
+    case SizingWhy::RiskPerShare:
+      return std::format("risk per share ${}", tag(n[0], color_of("info")));
+
+    case SizingWhy::HighCorr:
+      return std::format("high SPY corr {}", tag(n[0], color_of("semi-bad")));
+    case SizingWhy::Hedge:
+      return std::format("defensive hedge {}",
+                         tag(n[0], color_of("semi-good")));
+    case SizingWhy::Corr:
+      return std::format("spy corr {}", tag(n[0], color_of("info")));
+    case SizingWhy::HighVol:
+      return std::format("high vol {}%", tag(n[0], color_of("semi-bad")));
+    case SizingWhy::ElevatedVol:
+      return std::format("elevated vol {}%", tag(n[0], color_of("caution")));
+    case SizingWhy::Vol:
+      return std::format("{}% vol", tag(n[0], color_of("info")));
+    case SizingWhy::PortfolioLimit:
+      return std::format("portfolio limit, using {}%",
+                         tag(n[0], color_of("semi-bad")));
+    case SizingWhy::PositionsOpen:
+      return std::format("{} positions open", tag(n.i(0), color_of("info")));
+
+    case SizingWhy::Portfolio:
+      return std::format("portfolio: {}/12 positions, {}% -> {}% risk",
+                         tag(n.i(0), "frost"), tag(n[1], "frost"),
+                         tag(n[2], "frost"));
+  }
+  return "";
+}
+
+template <FormatTarget target>
+inline std::string rationale_str(const Rationale<SizingWhy>& r) {
+  if (r.empty())
+    return "";
+
+  auto sep = tagged_as<target>(" | ", color_of("comment"));
+  auto reasons = r.join(Part::Reason, sep, note_str<target>);
+  auto details = r.join(Part::Detail, sep, note_str<target>);
+
+  // a sizing that was rejected early has no portfolio context
+  if (!r.has(Part::Context)) {
+    if constexpr (target == FormatTarget::HTML)
+      return std::format("{}<br><div class=\"rationale-details\">{}</div>",
+                         reasons, details);
+    else
+      return std::format("{}\n{}", reasons, details);
+  }
+
+  auto portfolio = r.join(Part::Context, sep, note_str<target>);
+  auto adjustments = r.join(Part::Adjust, sep, note_str<target>);
+
+  if constexpr (target == FormatTarget::HTML) {
+    if (!adjustments.empty()) {
+      constexpr auto templ = R"(
       {}
       <div class="rationale-details">{} | {}</div>
       <div class="rationale-details">{}</div>
     )";
-    rationale = std::format(                                //
-        templ,                                              //
-        join(reasons.begin(), reasons.end(), sep),          //
-        portfolio_str,                                      //
-        join(adjustments.begin(), adjustments.end(), sep),  //
-        join(details.begin(), details.end(), sep)           //
-    );
-  } else {
+      return std::format(templ, reasons, portfolio, adjustments, details);
+    }
+
     constexpr auto templ = R"(
       {}
       <div class="rationale-details">{} | {}</div>
     )";
-    rationale = std::format(                                      //
-        templ,                                                    //
-        join(reasons.begin(), reasons.end(), sep),                //
-        portfolio_str, join(details.begin(), details.end(), sep)  //
-    );
+    return std::format(templ, reasons, portfolio, details);
+  } else {
+    if (!adjustments.empty())
+      return std::format("{}\n{} | {}\n{}", reasons, portfolio, adjustments,
+                         details);
+    return std::format("{}\n{} | {}", reasons, portfolio, details);
   }
 }
+
+template <>
+std::string to_str<FormatTarget::HTML>(const Rationale<SizingWhy>& r,
+                                       const PositionSizing&) {
+  return rationale_str<FormatTarget::HTML>(r);
+}
+
+template <>
+std::string to_str<FormatTarget::Telegram>(const Rationale<SizingWhy>& r,
+                                           const PositionSizing&) {
+  return rationale_str<FormatTarget::Telegram>(r);
+}
@@ -1,5 +1,6 @@
 #include "risk/stop_loss.h"
 
+#include "util/arena.h"
 #include "util/config.h"
 #include "util/format.h"
 
@@ -194,8 +195,8 @@ StopLoss::StopLoss(const Metrics& m,
   double daily_atr = ind_1d.atr(idx_1d);
   double daily_atr_pct = daily_atr / price;
 
-  std::deque<fmt_string> reasons;
-  std::vector<fmt_string> details;
+  auto& r = rationale;
+  r.notes.reserve(10);
 
   auto [atr_mult, atr_base] = calculate_base_atr_stop(m, tp, regime);
   atr_multiplier = atr_mult;
@@ -205,45 +206,34 @@ StopLoss::StopLoss(const Metrics& m,
 
   // atr details
   double regime_adj = calculate_regime_adjustment(regime);
-  details.emplace_back("atr stop: {:.2f} ({} x {})", atr_stop_base,
-                       tagged(atr_multiplier, color_of_stops("atr")),
-                       tagged(regime_adj, "slate"));
+  r.add(Part::Detail, StopWhy::AtrStop, atr_stop_base, atr_multiplier,
+        regime_adj);
 
   // Support details
   if (support_stop_base > 0) {
     double buffer = calculate_support_buffer(daily_atr_pct);
-    details.emplace_back("support: {:.2f} (-{}% buffer)", support_stop_base,
-                         tagged(buffer * 100, color_of_stops("support")));
+    r.add(Part::Detail, StopWhy::SupportStop, support_stop_base,
+          buffer * 100);
   }
 
   if (context == StopContext::NEW_POSITION) {
     new_position_stop = std::max(atr_stop_base, support_stop_base);
     entry_price = price;
 
-    if (support_stop_base > atr_stop_base) {
-      reasons.emplace_back("using " +
-                           tagged("support", color_of_stops("support"), BOLD));
-    } else {
-      reasons.emplace_back("using " +
-                           tagged("atr", color_of_stops("atr"), BOLD));
-    }
-    reasons.emplace_back("{} (-{}%)", tagged(new_position_stop, "blue", BOLD),
-                         tagged(get_stop_percentage(price) * 100, "blue"));
+    r.add(Part::Reason, support_stop_base > atr_stop_base
+                            ? StopWhy::UsingSupport
+                            : StopWhy::UsingAtr);
+    r.add(Part::Reason, StopWhy::Stop, new_position_stop,
+          get_stop_percentage(price) * 100, context);
 
   } else if (context == StopContext::SCALE_UP_ENTRY) {
     scale_up_stop = std::max(atr_stop_base, support_stop_base);
 
-    if (support_stop_base > atr_stop_base) {
-      reasons.emplace_back("using " +
-                           tagged("support", color_of_stops("support"), BOLD));
-    } else {
-      reasons.emplace_back("using " +
-                           tagged("atr", color_of_stops("atr"), BOLD));
-    }
-    reasons.emplace_back(
-        "{} (-{}%)", tagged(scale_up_stop, color_of_stops("trailing"), BOLD),
-        tagged((price - scale_up_stop) / price * 100,
-               color_of_stops("trailing")));
+    r.add(Part::Reason, support_stop_base > atr_stop_base
+                            ? StopWhy::UsingSupport
+                            : StopWhy::UsingAtr);
+    r.add(Part::Reason, StopWhy::Stop, scale_up_stop,
+          (price - scale_up_stop) / price * 100, context);
 
   } else {
     // Position exists, determine context automatically
@@ -269,24 +259,12 @@ StopLoss::StopLoss(const Metrics& m,
           max_price_seen, daily_atr, atr_multiplier, estimated_days_to_1r);
       trailing_stop_value = std::max(trailing_stop_value, entry_price);
 
-      if (estimated_days_to_1r <= 3) {
-        reasons.emplace_back(
-            tagged("tight (fast 1R)", color_of("caution"), BOLD));
-      } else if (estimated_days_to_1r <= 7) {
-        reasons.emplace_back(tagged("moderate", color_of("semi-good")));
-      } else {
-        reasons.emplace_back(tagged("loose", color_of("neutral")));
-      }
-
-      details.emplace_back("from max {} at {}x",
-                           tagged(max_price_seen, color_of("info")),
-                           tagged(trailing_adj, color_of("info")));
-
-      reasons.emplace_back(
-          "{} (-{}%)",
-          tagged(trailing_stop_value, color_of_stops("trailing"), BOLD),
-          tagged((price - trailing_stop_value) / price * 100,
-                 color_of_stops("trailing")));
+      r.add(Part::Reason, estimated_days_to_1r <= 3   ? StopWhy::Tight
+                          : estimated_days_to_1r <= 7 ? StopWhy::Moderate
+                                                      : StopWhy::Loose);
+      r.add(Part::Detail, StopWhy::FromMax, max_price_seen, trailing_adj);
+      r.add(Part::Reason, StopWhy::Stop, trailing_stop_value,
+            (price - trailing_stop_value) / price * 100, context);
 
     } else if (days_held <= 2) {
       context = StopContext::EXISTING_INITIAL;
@@ -296,57 +274,113 @@ StopLoss::StopLoss(const Metrics& m,
       initial_period_stop =
           apply_time_adjustment(entry_price, base_stop, days_held);
 
-      if (time_adj > 1.0) {
-        reasons.emplace_back("{}% wider", tagged((int)((time_adj - 1.0) * 100),
-                                                 color_of("risk")));
-      }
-      reasons.emplace_back(
-          "{} (-{}%)",
-          tagged(initial_period_stop, color_of_stops("initial"), BOLD),
-          tagged((entry_price - initial_period_stop) / entry_price * 100,
-                 color_of_stops("initial")));
+      if (time_adj > 1.0)
+        r.add(Part::Reason, StopWhy::Wider, (int)((time_adj - 1.0) * 100));
+      r.add(Part::Reason, StopWhy::Stop, initial_period_stop,
+            (entry_price - initial_period_stop) / entry_price * 100, context);
 
     } else {
       context = StopContext::EXISTING_STANDARD;
 
-      if (support_stop_base > atr_stop_base) {
-        reasons.emplace_back(
-            "using " + tagged("support", color_of_stops("support"), BOLD));
-      } else {
-        reasons.emplace_back("using  " +
-                             tagged("atr", color_of_stops("atr"), BOLD));
-      }
-      reasons.emplace_back(
-          "{} (-{}%)", tagged(standard_period_stop, "blue", BOLD),
-          tagged((entry_price - standard_period_stop) / entry_price * 100,
-                 "blue"));
+      r.add(Part::Reason, support_stop_base > atr_stop_base
+                              ? StopWhy::UsingSupport
+                              : StopWhy::UsingAtr);
+      r.add(Part::Reason, StopWhy::Stop, standard_period_stop,
+            (entry_price - standard_period_stop) / entry_price * 100, context);
     }
   }
 
-  if (context != StopContext::EXISTING_INITIAL)
-    reasons.emplace_front(tagged(context, color_of(context), BOLD));
-  else
-    reasons.emplace_front("{}, (day {})",
-                          tagged(context, color_of(context), BOLD),
-                          days_held + 1);
+  r.add_front(Part::Reason, StopWhy::Context, context, days_held + 1);
 
   // Add regime context
-  reasons.emplace_back(tagged(regime, "blue"));
-  if (regime_adj > 1.0) {
-    details.emplace_back(
-        "regime adj +{}%",
-        tagged((int)((regime_adj - 1.0) * 100), color_of("info")));
-  }
+  r.add(Part::Reason, StopWhy::Regime, regime);
+  if (regime_adj > 1.0)
+    r.add(Part::Detail, StopWhy::RegimeAdj, (int)((regime_adj - 1.0) * 100));
 
   // Add volatility context
-  details.emplace_back("{}% daily vol",
-                       tagged(daily_atr_pct * 100, color_of("info")));
-
-  // Build final rationale
-  rationale = std::format(
-      "{}<br><div class=\"rationale-details\">{}</div>",
-      join(reasons.begin(), reasons.end(), tagged(" | ", color_of("comment"))),
-      join(details.begin(), details.end(), tagged(" | ", color_of("comment"))));
+  r.add(Part::Detail, StopWhy::DailyVol, daily_atr_pct * 100);
+}
+
+template <FormatTarget target>
+inline std::string note_str(const Rationale<StopWhy>::Note& n) {
+  auto tag = [](auto&& v, auto... tags) {
+    return tagged_as<target>(v, tags...);
+  };
+
+  switch (n.code) {
+    case StopWhy::Context: {
+      auto ctx = n.as<StopContext>(0);
+      auto str = tag(ctx, color_of(ctx), BOLD);
+      if (ctx != StopContext::EXISTING_INITIAL)
+        return str;
+      return std::format("{}, (day {})", str, n.i(1));
+    }
+    case StopWhy::UsingSupport:
+      return "using " + tag("support", color_of_stops("support"), BOLD);
+    case StopWhy::UsingAtr:
+      return "using " + tag("atr", color_of_stops("atr"), BOLD);
+    case StopWhy::Stop: {
+      auto ctx = n.as<StopContext>(2);
+      auto color = ctx == StopContext::EXISTING_INITIAL ? color_of_stops("initial")
+                   : ctx == StopContext::SCALE_UP_ENTRY ||
+                           ctx == StopContext::EXISTING_TRAILING
+                       ? color_of_stops("trailing")
+                       : "blue";
+      return std::format("{} (-{}%)", tag(n[0], color, BOLD), tag(n[1], color));
+    }
+    case StopWhy::Tight:
+      return tag("tight (fast 1R)", color_of("caution"), BOLD);
+    case StopWhy::Moderate:
+      return tag("moderate", color_of("semi-good"));
+    case StopWhy::Loose:
+      return tag("loose", color_of("neutral"));
+    case StopWhy::Wider:
+      return std::format("{}% wider", tag(n.i(0), color_of("risk")));
+    case StopWhy::Regime:
+      return tag(n.as<MarketRegime>(0), "blue");
+    case StopWhy::AtrStop:
+      return std::format("atr stop: {:.2f} ({} x {})", n[0],
+                         tag(n[1], color_of_stops("atr")), tag(n[2], "slate"));
+    case StopWhy::SupportStop:
+      return std::format("support: {:.2f} (-{}% buffer)", n[0],
+                         tag(n[1], color_of_stops("support")));
+    case StopWhy::FromMax:
+      return std::format("from max {} at {}x", tag(n[0], color_of("info")),
+                         tag(n[1], color_of("info")));
+    case StopWhy::RegimeAdj:
+      return std::format("regime adj +{}%", tag(n.i(0), color_of("info")));
+    case StopWhy::DailyVol:
+      return std::format("{}% daily vol", tag(n[0], color_of("info")));
+  }
+  return "";
+}
+
+template <FormatTarget target>
+inline std::string rationale_str(const Rationale<StopWhy>& r) {
+  if (r.empty())
+    return "";
+
+  auto sep = tagged_as<target>(" | ", color_of("comment"));
+  auto reasons = r.join(Part::Reason, sep, note_str<target>);
+  auto details = r.join(Part::Detail, sep, note_str<target>);
+
+  if constexpr (target == FormatTarget::HTML)
+    return std::format("{}<br><div class=\"rationale-details\">{}</div>",
+                       reasons, details);
+  else
+    return std::format("{}\n{}", reasons, details);
+}
+
+template <>
+std::string to_str<FormatTarget::HTML>(const Rationale<StopWhy>& r,
+                                       const StopLoss&) {
+  return rationale_str<FormatTarget::HTML>(r);
+}
+
+template <>
+std::string to_str<FormatTarget::Telegram>(const Rationale<StopWhy>& r,
+                                           const StopLoss&) {
+  return rationale_str<FormatTarget::Telegram>(r);
 }
 
 // Primary interface methods
@@ -1,4 +1,5 @@
 #include "risk/target.h"
+#include "util/arena.h"
 #include "util/config.h"
 #include "util/format.h"
 
@@ -52,20 +53,20 @@ ProfitTarget::ProfitTarget(const Metrics& m,
   double stop_price = stop_loss.get_stop_price();
   double risk_amount = current_price - stop_price;
 
-  std::vector<std::string> reasons;
-  std::vector<std::string> details;
+  auto& r = rationale;
+  r.notes.reserve(10);
 
   // Find resistance levels across timeframes
   struct ResistanceLevel {
     double price;
     double confidence;
     double distance_pct;
-    std::string timeframe;
+    minutes timeframe;
   };
-  std::vector<ResistanceLevel> resistances;
+  std::pmr::vector<ResistanceLevel> resistances{scratch()};
 
   // Check each timeframe
-  auto check_resistance = [&](const auto& ind, const std::string& tf) {
+  auto check_resistance = [&](const auto& ind, minutes tf) {
     auto res_opt = ind.nearest_resistance_above(ind.idx_for_time(tp));
     if (res_opt) {
       const auto& zone = res_opt->get();
@@ -78,19 +79,16 @@ ProfitTarget::ProfitTarget(const Metrics& m,
     }
   };
 
-  check_resistance(m.ind_1d, "1D");
-  check_resistance(m.ind_4h, "4H");
-  check_resistance(m.ind_1h, "1H");
+  check_resistance(m.ind_1d, D_1);
+  check_resistance(m.ind_4h, H_4);
+  check_resistance(m.ind_1h, H_1);
 
   // Sort by confidence and timeframe priority
   std::sort(
       resistances.begin(), resistances.end(), [](const auto& a, const auto& b) {
         // Prioritize daily over 4H over 1H
-        int priority_a = a.timeframe == "1D" ? 3 : a.timeframe == "4H" ? 2 : 1;
-        int priority_b = b.timeframe == "1D" ? 3 : b.timeframe == "4H" ? 2 : 1;
-
-        if (priority_a != priority_b)
-          return priority_a > priority_b;
+        if (a.timeframe != b.timeframe)
+          return a.timeframe > b.timeframe;
 
         return a.confidence > b.confidence;
       });
@@ -99,17 +97,13 @@ ProfitTarget::ProfitTarget(const Metrics& m,
   if (!resistances.empty() && resistances[0].confidence >= 0.6) {
     nearest_resistance = resistances[0].price;
     resistance_room_pct = resistances[0].distance_pct;
-    resistance_timeframe = resistances[0].timeframe == "1D"   ? D_1
-                           : resistances[0].timeframe == "4H" ? H_4
-                                                              : H_1;
-
-    details.push_back(std::format("{} resistance at {:.2f} (+{:.1f}%)",
-                                  tagged(resistances[0].timeframe, "cyan"),
-                                  nearest_resistance,
-                                  resistance_room_pct * 100));
+    resistance_timeframe = resistances[0].timeframe;
+
+    r.add(Part::Detail, TargetWhy::Resistance, resistance_timeframe.count(),
+          nearest_resistance, resistance_room_pct * 100);
   } else {
     resistance_room_pct = 0.15;  // Assume 15% room if no resistance
-    details.push_back(tagged("No major resistance", "green"));
+    r.add(Part::Detail, TargetWhy::NoResistance);
   }
 
   // Select strategy based on setup quality and room
@@ -136,8 +130,8 @@ ProfitTarget::ProfitTarget(const Metrics& m,
   atr_projection =
       current_price + calculate_atr_projection(m, tp, expected_days_to_target);
 
-  details.push_back(std::format("ATR projection: {:.2f} in {} days",
-                                atr_projection, expected_days_to_target));
+  r.add(Part::Detail, TargetWhy::AtrProjection, atr_projection,
+        expected_days_to_target);
 
   // Determine final target
   if (nearest_resistance > 0 && nearest_resistance < rr_based_target) {
@@ -146,35 +140,31 @@ ProfitTarget::ProfitTarget(const Metrics& m,
       // At least 1.5:1, use resistance
       target_price = nearest_resistance;
       risk_reward_ratio = (target_price - current_price) / risk_amount;
-      reasons.push_back(
-          std::format("Using {} resistance",
-                      tagged(resistances[0].timeframe, "cyan", BOLD)));
+      r.add(Part::Reason, TargetWhy::UsingResistance,
+            resistances[0].timeframe.count());
     } else {
       // Resistance too close, skip to next resistance or use R:R
       if (resistances.size() > 1 && resistances[1].price < rr_based_target) {
         target_price = resistances[1].price;
         risk_reward_ratio = (target_price - current_price) / risk_amount;
-        reasons.push_back(
-            std::format("Using {} resistance (2nd)",
-                        tagged(resistances[1].timeframe, "cyan")));
+        r.add(Part::Reason, TargetWhy::UsingSecond,
+              resistances[1].timeframe.count());
       } else {
         target_price = rr_based_target;
         risk_reward_ratio = target_rr;
-        reasons.push_back(std::format("R:R based (res too close)",
-                                      tagged(target_rr, "blue", BOLD)));
+        r.add(Part::Reason, TargetWhy::ResTooClose);
       }
     }
   } else if (atr_projection < rr_based_target * 0.9) {
     // ATR suggests lower target is more realistic
     target_price = atr_projection;
     risk_reward_ratio = (target_price - current_price) / risk_amount;
-    reasons.push_back(std::format("ATR-limited target", tagged("amber", BOLD)));
+    r.add(Part::Reason, TargetWhy::AtrLimited);
   } else {
     // Use R:R based target
     target_price = rr_based_target;
     risk_reward_ratio = target_rr;
-    reasons.push_back(
-        std::format("{}:1 R:R target", tagged(target_rr, "forest", BOLD)));
+    r.add(Part::Reason, TargetWhy::RRTarget, target_rr);
   }
 
   // Calculate final metrics
@@ -185,38 +175,103 @@ ProfitTarget::ProfitTarget(const Metrics& m,
     target_price = current_price * 1.15;  // Cap at 15%
     risk_reward_ratio = (target_price - current_price) / risk_amount;
     target_pct = 0.15;
-    reasons.push_back(tagged("Capped at 15%", "yellow"));
+    r.add(Part::Reason, TargetWhy::Capped);
   }
 
-  // Strategy description
-  std::string strategy_str =
-      strategy == TargetStrategy::AGGRESSIVE ? "Aggressive"
-      : strategy == TargetStrategy::STANDARD ? "Standard"
-                                             : "Conservative";
-
-  reasons.insert(reasons.begin(), tagged(strategy_str, "sage", BOLD));
+  r.add_front(Part::Reason, TargetWhy::Strategy, strategy);
 
   // Summary
-  details.push_back(std::format("Target: {} (+{}%)",
-                                tagged(target_price, "emerald", BOLD),
-                                tagged(target_pct * 100, "emerald")));
-  details.push_back(
-      std::format("R:R: {}:1", tagged(risk_reward_ratio, "emerald", BOLD)));
+  r.add(Part::Detail, TargetWhy::Target, target_price, target_pct * 100);
+  r.add(Part::Detail, TargetWhy::RR, risk_reward_ratio);
 
   // Special conditions
-  if (risk_reward_ratio < risk_config.min_rr_ratio) {
-    details.push_back(tagged("Below min R:R - consider skipping", "red", BOLD));
-  }
+  if (risk_reward_ratio < risk_config.min_rr_ratio)
+    r.add(Part::Detail, TargetWhy::BelowMinRR);
 
   if (signal.forecast.exp_pnl > 0) {
     double expected_return = signal.forecast.exp_pnl;
-    if (expected_return < target_pct * 100 * 0.5) {
-      details.push_back(std::format("Forecast suggests {}% only",
-                                    tagged(expected_return, "amber")));
+    if (expected_return < target_pct * 100 * 0.5)
+      r.add(Part::Detail, TargetWhy::ForecastOnly, expected_return);
+  }
+}
+
+inline std::string tf_label(double tf) {
+  auto t = minutes{static_cast<minutes::rep>(tf)};
+  return t == D_1 ? "1D" : t == H_4 ? "4H" : "1H";
+}
+
+template <FormatTarget target>
+inline std::string note_str(const Rationale<TargetWhy>::Note& n) {
+  auto tag = [](auto&& v, auto... tags) {
+    return tagged_as<target>(v, tags...);
+  };
+
+  switch (n.code) {
+    case TargetWhy::Strategy: {
+      auto strategy = n.as<TargetStrategy>(0);
+      return tag(strategy == TargetStrategy::AGGRESSIVE ? "Aggressive"
+                 : strategy == TargetStrategy::STANDARD ? "Standard"
+                                                        : "Conservative",
+                 "sage", BOLD);
     }
+    case TargetWhy::UsingResistance:
+      return std::format("Using {} resistance",
+                         tag(tf_label(n[0]), "cyan", BOLD));
+    case TargetWhy::UsingSecond:
+      return std::format("Using {} resistance (2nd)",
+                         tag(tf_label(n[0]), "cyan"));
+    case TargetWhy::ResTooClose:
+      return "R:R based (res too close)";
+    case TargetWhy::AtrLimited:
+      return "ATR-limited target";
+    case TargetWhy::RRTarget:
+      return std::format("{}:1 R:R target", tag(n[0], "forest", BOLD));
+    case TargetWhy::Capped:
+      return tag("Capped at 15%", "yellow");
+
+    case TargetWhy::Resistance:
+      return std::format("{} resistance at {:.2f} (+{:.1f}%)",
+                         tag(tf_label(n[0]), "cyan"), n[1], n[2]);
+    case TargetWhy::NoResistance:
+      return tag("No major resistance", "green");
+    case TargetWhy::AtrProjection:
+      return std::format("ATR projection: {:.2f} in {} days", n[0], n.i(1));
+    case TargetWhy::Target:
+      return std::format("Target: {} (+{}%)", tag(n[0], "emerald", BOLD),
+                         tag(n[1], "emerald"));
+    case TargetWhy::RR:
+      return std::format("R:R: {}:1", tag(n[0], "emerald", BOLD));
+    case TargetWhy::BelowMinRR:
+      return tag("Below min R:R - consider skipping", "red", BOLD);
+    case TargetWhy::ForecastOnly:
+      return std::format("Forecast suggests {}% only", tag(n[0], "amber"));
   }
+  return "";
+}
+
+template <FormatTarget target>
+inline std::string rationale_str(const Rationale<TargetWhy>& r) {
+  if (r.empty())
+    return "";
+
+  auto reasons = r.join(Part::Reason, " | ", note_str<target>);
+  auto details = r.join(Part::Detail, " | ", note_str<target>);
+
+  if constexpr (target == FormatTarget::HTML)
+    return std::format("{}<br><div class=\"rationale-details\">{}</div>",
+                       reasons, details);
+  else
+    return std::format("{}\n{}", reasons, details);
+}
+
+template <>
+std::string to_str<FormatTarget::HTML>(const Rationale<TargetWhy>& r,
+                                       const ProfitTarget&) {
+  return rationale_str<FormatTarget::HTML>(r);
+}
 
-  rationale = std::format("{}<br><div class=\"rationale-details\">{}</div>",
-                          join(reasons.begin(), reasons.end(), " | "),
-                          join(details.begin(), details.end(), " | "));
+template <>
+std::string to_str<FormatTarget::Telegram>(const Rationale<TargetWhy>& r,
+                                           const ProfitTarget&) {
+  return rationale_str<FormatTarget::Telegram>(r);
 }
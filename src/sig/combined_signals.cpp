@@ -6,6 +6,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <iterator>
+
 inline auto& sig_config = config.sig_config;
 
 // More lenient disqualification for swing trades
@@ -44,17 +46,9 @@ struct FilterBias {
   double net_bearish = 0.0;
   int strong_bullish = 0;
   int strong_bearish = 0;
-  std::string key_signals;
 
   FilterBias(const Filters& filters) {
-    std::vector<std::string> key_items;
-
-    for (auto& [inv, filter_list] : filters) {
-      auto tf_label = inv == H_1.count()   ? "1h"
-                      : inv == H_4.count() ? "4h"
-                      : inv == D_1.count() ? "1d"
-                                           : "align";
-
+    for (auto& [_, filter_list] : filters) {
       for (auto& f : filter_list) {
         double weight = (f.conf == Confidence::High)     ? 1.0
                         : (f.conf == Confidence::Medium) ? 0.6
@@ -63,34 +57,43 @@ struct FilterBias {
         if (f.trend == Trend::StrongUptrend ||
             f.trend == Trend::ModerateUptrend) {
           net_bullish += weight;
-          if (f.conf == Confidence::High) {
+          if (f.conf == Confidence::High)
             strong_bullish++;
-            if (!f.str.empty())
-              key_items.push_back(std::format("{}: {}", tf_label, f.str));
-          }
         } else if (f.trend == Trend::Bearish) {
           net_bearish += weight;
-          if (f.conf == Confidence::High) {
+          if (f.conf == Confidence::High)
             strong_bearish++;
-            if (!f.str.empty())
-              key_items.push_back(std::format("{}: {}", tf_label, f.str));
-          }
         }
       }
     }
+  }
+};
 
-    // Keep only top 3 most significant signals
-    if (key_items.size() > 3)
-      key_items.resize(3);
-
-    key_signals = "";
-    for (size_t i = 0; i < key_items.size(); ++i) {
-      if (i > 0)
-        key_signals += " ";
-      key_signals += key_items[i];
+// the top 3 most significant filters, only needed to render a rationale
+inline std::string key_signals(const Filters& filters) {
+  std::string res;
+  int n = 0;
+
+  for (auto& [inv, filter_list] : filters) {
+    auto tf_label = inv == H_1.count()   ? "1h"
+                    : inv == H_4.count() ? "4h"
+                    : inv == D_1.count() ? "1d"
+                                         : "align";
+
+    for (auto& f : filter_list) {
+      bool directional = f.trend == Trend::StrongUptrend ||
+                         f.trend == Trend::ModerateUptrend ||
+                         f.trend == Trend::Bearish;
+      if (!directional || f.conf != Confidence::High || f.str.empty())
+        continue;
+      if (n++ == 3)
+        return res;
+      std::format_to(std::back_inserter(res), "{}{}: {}", n > 1 ? " " : "",
+                     tf_label, f.str);
     }
   }
-};
+  return res;
+}
 
 inline int count_filters(auto& filters, Trend trend_type, Confidence min_conf) {
   return std::count_if(filters.begin(), filters.end(), [=](auto& f) {
@@ -98,153 +101,131 @@ inline int count_filters(auto& filters, Trend trend_type, Confidence min_conf) {
   });
 }
 
-inline std::tuple<Rating, double, std::string> contextual_rating(
+inline std::pair<Rating, double> contextual_rating(
     auto& sig_1h,
     auto& sig_4h,
     auto& sig_1d,
     auto& filters,
-    bool has_position  //
+    bool has_position,
+    Rationale<SignalWhy>& r  //
 ) {
   Rating base_rating = sig_1h.type;
   double score_mod = 0.0;
-  std::vector<fmt_string> reasons;
+  auto reason = [&](SignalWhy why) { r.add(Part::Reason, why); };
 
   FilterBias filter_bias{filters};
 
   if (base_rating == Rating::Entry) {
-    reasons.emplace_back("1h {}", tagged("entry", color_of("good"), BOLD));
+    reason(SignalWhy::H1Entry);
 
     // Check 1d confirmation first (most important for swing trades)
     if (sig_1d.type == Rating::Entry || sig_1d.type == Rating::Watchlist) {
-      reasons.emplace_back("1d {} strongly",
-                           tagged("confirms", color_of("good"), BOLD));
+      reason(SignalWhy::D1Confirms);
       score_mod += 0.04;
     } else if (sig_1d.type == Rating::Exit || sig_1d.type == Rating::Caution) {
-      reasons.emplace_back("1d {} -> {}",
-                           tagged("conflicts", color_of("bad"), BOLD),
-                           tagged("downgrading", color_of("semi-bad"), IT));
+      reason(SignalWhy::D1Conflicts);
       base_rating = Rating::Watchlist;
       score_mod -= 0.05;
     } else {
-      reasons.emplace_back("1d neutral");
+      reason(SignalWhy::D1Neutral);
     }
 
     // Then 4h confirmation
     if (sig_4h.type == Rating::Entry || sig_4h.type == Rating::Watchlist) {
-      reasons.emplace_back("4h {}", tagged("confirms", color_of("good"), IT));
+      reason(SignalWhy::H4Confirms);
       score_mod += 0.03;
     } else if (sig_4h.type == Rating::Exit && base_rating == Rating::Entry) {
-      reasons.emplace_back("4h {}", tagged("conflicts", color_of("bad"), IT));
+      reason(SignalWhy::H4Conflicts);
       base_rating = Rating::Mixed;
       score_mod -= 0.03;
     } else {
-      reasons.emplace_back("4h neutral");
+      reason(SignalWhy::H4Neutral);
     }
 
     // Filter integration
     if (filter_bias.strong_bullish >= 3) {
-      reasons.emplace_back("filters: {} ({})",
-                           tagged("excellent", color_of("good"), BOLD),
-                           filter_bias.key_signals);
+      reason(SignalWhy::FiltersExcellent);
       score_mod += 0.035;
     } else if (filter_bias.strong_bearish >= 2) {
-      reasons.emplace_back("filters: {} – caution",
-                           tagged("bearish", color_of("bad"), IT));
+      reason(SignalWhy::FiltersBearish);
       base_rating = Rating::Watchlist;
       score_mod -= 0.04;
     } else {
-      reasons.emplace_back("filters: {}", tagged("mixed", IT));
+      reason(SignalWhy::FiltersMixed);
     }
 
   } else if (base_rating == Rating::Watchlist) {
-    reasons.emplace_back("1h {}", tagged("watchlist", color_of("wishful")));
+    reason(SignalWhy::H1Watchlist);
 
     if ((sig_1d.type == Rating::Entry || sig_1d.type == Rating::Watchlist) &&
         sig_4h.type == Rating::Entry && filter_bias.strong_bullish >= 2) {
-      reasons.emplace_back("strong 4h+1d support -> {}",
-                           tagged("upgrading", color_of("good"), BOLD));
+      reason(SignalWhy::HtfUpgrade);
       base_rating = Rating::Entry;
       score_mod += 0.035;
     } else if (sig_1d.type == Rating::Entry && filter_bias.net_bullish > 2) {
-      reasons.emplace_back("1d {} + filters -> {}",
-                           tagged("entry", color_of("good")),
-                           tagged("upgrade", color_of("good")));
+      reason(SignalWhy::D1Upgrade);
       base_rating = Rating::Entry;
       score_mod += 0.03;
     } else if (sig_1d.type == Rating::Exit || filter_bias.strong_bearish >= 2) {
-      reasons.emplace_back("htf {}", tagged("bearish", color_of("bad"), IT));
+      reason(SignalWhy::HtfBearish);
       base_rating = Rating::Caution;
       score_mod -= 0.03;
     } else {
-      reasons.emplace_back("htf {}", tagged("mixed", color_of("mixed")));
+      reason(SignalWhy::HtfMixed);
     }
 
   } else if (base_rating == Rating::Exit) {
-    reasons.emplace_back("1h {}", tagged("exit", color_of("bad"), BOLD));
+    reason(SignalWhy::H1Exit);
 
     if (sig_1d.type == Rating::Exit || sig_4h.type == Rating::Exit) {
-      reasons.emplace_back("htf {} exit",
-                           tagged("confirms", color_of("bad"), BOLD));
+      reason(SignalWhy::HtfConfirmsExit);
       score_mod -= 0.06;
     } else if (sig_1d.type == Rating::Entry && !has_position) {
-      reasons.emplace_back("1d bullish -> {}",
-                           tagged("downgrading exit", color_of("caution"), IT));
+      reason(SignalWhy::D1DowngradesExit);
       base_rating = Rating::Caution;
       score_mod += 0.04;
     }
 
     if (filter_bias.strong_bearish >= 2) {
-      reasons.emplace_back("filters {}",
-                           tagged("confirm bearish", color_of("bad"), BOLD));
+      reason(SignalWhy::FiltersConfirmBearish);
       score_mod -= 0.025;
     }
 
   } else if (base_rating == Rating::None || base_rating == Rating::Mixed) {
     if (sig_1d.type == Rating::Entry && filter_bias.strong_bullish >= 2) {
-      reasons.emplace_back("1h {}, but 1d+filters {}",                  //
-                           tagged("neutral", color_of("neutral"), IT),  //
-                           tagged("bullish", color_of("good"), BOLD));
+      reason(SignalWhy::NeutralButBullish);
       base_rating = Rating::Watchlist;
       score_mod += 0.025;
     } else if (sig_4h.type == Rating::Entry && sig_1d.type != Rating::Exit) {
-      reasons.emplace_back("1h {}, 4h shows {}",                        //
-                           tagged("neutral", color_of("neutral"), IT),  //
-                           tagged("potential", color_of("wishful"), IT));
+      reason(SignalWhy::NeutralPotential);
       base_rating = Rating::Watchlist;
     } else if (sig_1d.type == Rating::Exit || filter_bias.strong_bearish >= 2) {
-      reasons.emplace_back("htf {}", tagged("bearish", color_of("bad"), BOLD));
+      reason(SignalWhy::HtfStrongBearish);
       base_rating = Rating::Caution;
       score_mod -= 0.02;
     } else {
-      reasons.emplace_back("1h, 4h, 1d {}",
-                           tagged("neutral", color_of("neutral"), IT));
+      reason(SignalWhy::AllNeutral);
     }
   }
 
   // Disqualification check
   if (disqualify(filters)) {
-    reasons.emplace_back("{} by filters",
-                         tagged("disqualified", color_of("bad"), BOLD));
-    auto rationale = join(reasons.begin(), reasons.end(), ", ");
-    return {Rating::Skip, score_mod, rationale};
+    reason(SignalWhy::Disqualified);
+    return {Rating::Skip, score_mod};
   }
 
   // Position adjustments
   if (base_rating == Rating::Caution && has_position) {
-    reasons.emplace_back("hold position {}",
-                         tagged("cautiously", color_of("caution"), IT));
+    reason(SignalWhy::HoldCautiously);
     base_rating = Rating::HoldCautiously;
   }
 
   if (base_rating == Rating::Exit && !has_position) {
-    reasons.emplace_back("no position to {}",
-                         tagged("exit", color_of("comment")));
+    reason(SignalWhy::NoPositionToExit);
     base_rating = Rating::Caution;
   }
 
-  auto rationale =
-      join(reasons.begin(), reasons.end(), tagged(", ", color_of("comment")));
-  return {base_rating, score_mod, rationale};
+  return {base_rating, score_mod};
 }
 
 inline Score weighted_score(Score score_1h,
@@ -283,20 +264,19 @@ void CombinedSignal::apply_stop_hit(StopHit hit) {
   stop_hit = hit;
 
   if (stop_hit.type == StopHitType::StopLossHit) {
-    rationale +=
-        std::format("{}! ", tagged("STOP HIT", color_of("bad"), BOLD, IT));
+    rationale.add(Part::Context, SignalWhy::StopHit);
     type = Rating::Exit;
     return;
   }
 
   if (stop_hit.type == StopHitType::TimeExit) {
-    rationale += std::format("{}", tagged("time exit", color_of("bad"), IT));
+    rationale.add(Part::Context, SignalWhy::TimeExit);
     type = Rating::Exit;
     return;
   }
 
   if (stop_hit.type == StopHitType::StopProximity && type == Rating::Entry) {
-    rationale += std::format("near {}", tagged("stop", "yellow", IT));
+    rationale.add(Part::Context, SignalWhy::NearStop);
     type = Rating::Mixed;
   }
 }
@@ -312,19 +292,134 @@ CombinedSignal::CombinedSignal(const Metrics& m,
       combined_forecast(sig_1h.forecast, sig_4h.forecast, sig_1d.forecast);
 
   filters = Filters{m};
-  auto [rating, mod, r_str] =
-      contextual_rating(sig_1h, sig_4h, sig_1d, filters, m.has_position());
+  auto [rating, mod] = contextual_rating(sig_1h, sig_4h, sig_1d, filters,
+                                         m.has_position(), rationale);
 
   type = rating;
-  rationale = r_str;
   score = weighted_score(sig_1h.score, sig_4h.score, sig_1d.score, mod);
 
   if (type == Rating::Entry) {
     if (ev.is_earnings() && ev.days_until() >= 0 &&
         ev.days_until() < config.risk_config.earnings_buffer_days) {
       type = Rating::Watchlist;
-      rationale += std::format("Earnings proximity - ",
-                               tagged("waiting", "yellow", BOLD));
+      rationale.add(Part::Context, SignalWhy::EarningsProximity);
     }
   }
 }
+
+template <FormatTarget target>
+inline std::string note_str(SignalWhy why, const Filters& filters) {
+  auto tag = [](auto&& v, auto... tags) {
+    return tagged_as<target>(v, tags...);
+  };
+
+  switch (why) {
+    case SignalWhy::H1Entry:
+      return std::format("1h {}", tag("entry", color_of("good"), BOLD));
+    case SignalWhy::D1Confirms:
+      return std::format("1d {} strongly",
+                         tag("confirms", color_of("good"), BOLD));
+    case SignalWhy::D1Conflicts:
+      return std::format("1d {} -> {}", tag("conflicts", color_of("bad"), BOLD),
+                         tag("downgrading", color_of("semi-bad"), IT));
+    case SignalWhy::D1Neutral:
+      return "1d neutral";
+    case SignalWhy::H4Confirms:
+      return std::format("4h {}", tag("confirms", color_of("good"), IT));
+    case SignalWhy::H4Conflicts:
+      return std::format("4h {}", tag("conflicts", color_of("bad"), IT));
+    case SignalWhy::H4Neutral:
+      return "4h neutral";
+    case SignalWhy::FiltersExcellent:
+      return std::format("filters: {} ({})",
+                         tag("excellent", color_of("good"), BOLD),
+                         key_signals(filters));
+    case SignalWhy::FiltersBearish:
+      return std::format("filters: {} – caution",
+                         tag("bearish", color_of("bad"), IT));
+    case SignalWhy::FiltersMixed:
+      return std::format("filters: {}", tag("mixed", IT));
+
+    case SignalWhy::H1Watchlist:
+      return std::format("1h {}", tag("watchlist", color_of("wishful")));
+    case SignalWhy::HtfUpgrade:
+      return std::format("strong 4h+1d support -> {}",
+                         tag("upgrading", color_of("good"), BOLD));
+    case SignalWhy::D1Upgrade:
+      return std::format("1d {} + filters -> {}",
+                         tag("entry", color_of("good")),
+                         tag("upgrade", color_of("good")));
+    case SignalWhy::HtfBearish:
+      return std::format("htf {}", tag("bearish", color_of("bad"), IT));
+    case SignalWhy::HtfMixed:
+      return std::format("htf {}", tag("mixed", color_of("mixed")));
+
+    case SignalWhy::H1Exit:
+      return std::format("1h {}", tag("exit", color_of("bad"), BOLD));
+    case SignalWhy::HtfConfirmsExit:
+      return std::format("htf {} exit", tag("confirms", color_of("bad"), BOLD));
+    case SignalWhy::D1DowngradesExit:
+      return std::format("1d bullish -> {}",
+                         tag("downgrading exit", color_of("caution"), IT));
+    case SignalWhy::FiltersConfirmBearish:
+      return std::format("filters {}",
+                         tag("confirm bearish", color_of("bad"), BOLD));
+
+    case SignalWhy::NeutralButBullish:
+      return std::format("1h {}, but 1d+filters {}",
+                         tag("neutral", color_of("neutral"), IT),
+                         tag("bullish", color_of("good"), BOLD));
+    case SignalWhy::NeutralPotential:
+      return std::format("1h {}, 4h shows {}",
+                         tag("neutral", color_of("neutral"), IT),
+                         tag("potential", color_of("wishful"), IT));
+    case SignalWhy::HtfStrongBearish:
+      return std::format("htf {}", tag("bearish", color_of("bad"), BOLD));
+    case SignalWhy::AllNeutral:
+      return std::format("1h, 4h, 1d {}",
+                         tag("neutral", color_of("neutral"), IT));
+
+    case SignalWhy::Disqualified:
+      return std::format("{} by filters",
+                         tag("disqualified", color_of("bad"), BOLD));
+    case SignalWhy::HoldCautiously:
+      return std::format("hold position {}",
+                         tag("cautiously", color_of("caution"), IT));
+    case SignalWhy::NoPositionToExit:
+      return std::format("no position to {}", tag("exit", color_of("comment")));
+
+    case SignalWhy::StopHit:
+      return std::format("{}! ", tag("STOP HIT", color_of("bad"), BOLD, IT));
+    case SignalWhy::TimeExit:
+      return tag("time exit", color_of("bad"), IT);
+    case SignalWhy::NearStop:
+      return std::format("near {}", tag("stop", "yellow", IT));
+    case SignalWhy::EarningsProximity:
+      return "Earnings proximity - ";
+  }
+  return "";
+}
+
+// the rating steps joined, then the stop and earnings notes appended as is
+template <FormatTarget target>
+inline std::string rationale_str(const CombinedSignal& s) {
+  auto& r = s.rationale;
+  auto str = [&](auto& n) { return note_str<target>(n.code, s.filters); };
+
+  auto sep = r.has(SignalWhy::Disqualified)
+                 ? std::string{", "}
+                 : tagged_as<target>(", ", color_of("comment"));
+  return r.join(Part::Reason, sep, str) + r.join(Part::Context, "", str);
+}
+
+template <>
+std::string to_str<FormatTarget::HTML>(const Rationale<SignalWhy>&,
+                                       const CombinedSignal& s) {
+  return rationale_str<FormatTarget::HTML>(s);
+}
+
+template <>
+std::string to_str<FormatTarget::Telegram>(const Rationale<SignalWhy>&,
+                                           const CombinedSignal& s) {
+  return rationale_str<FormatTarget::Telegram>(s);
+}
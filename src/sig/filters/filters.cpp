@@ -1,15 +1,37 @@
 #include "sig/filters.h"
 #include "ind/indicators.h"
+#include "sig/rule_profile.h"
+#include "util/trace.h"
 
 std::vector<Filter> evaluate_timeframe_alignment(const Metrics& m);
 std::vector<Filter> evaluate_1h_trends(const Metrics& m);
 std::vector<Filter> evaluate_4h_trends(const Metrics& m);
 std::vector<Filter> evaluate_1d_trends(const Metrics& m);
 
+// names for the rule profile, with the timeframe each one looks at
+inline constexpr const char* filter_names[] = {
+    "evaluate_timeframe_alignment",
+    "evaluate_1h_trends",
+    "evaluate_4h_trends",
+    "evaluate_1d_trends",
+};
+
+inline size_t filter_rule(size_t k) {
+  static const auto first = rule_profiler.add("filter", filter_names);
+  return first + k;
+}
+
 Filters::Filters(const Metrics& m) {
-  try_emplace(0, evaluate_timeframe_alignment(m));
-  try_emplace(H_1.count(), evaluate_1h_trends(m));
-  try_emplace(H_4.count(), evaluate_4h_trends(m));
-  try_emplace(D_1.count(), evaluate_1d_trends(m));
+  Span _{"filters"};
+
+  auto run = [&](size_t k, minutes tf, auto f) {
+    auto prof = rule_profiler.slot(filter_rule(k), RulePath::Live, tf);
+    try_emplace(tf.count(), profiled(prof, f, m));
+  };
+
+  run(0, minutes{0}, evaluate_timeframe_alignment);
+  run(1, H_1, evaluate_1h_trends);
+  run(2, H_4, evaluate_4h_trends);
+  run(3, D_1, evaluate_1d_trends);
   classify();
 }
@@ -1,5 +1,6 @@
 #include "ind/indicators.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 #include "util/config.h"
 #include "util/format.h"
 
@@ -7,7 +8,7 @@ inline auto& sig_config = config.sig_config;
 
 Hint rsi_bullish_divergence(const IndicatorsTrends& ind, int idx) {
   const int LOOKBACK = 10;  // Look back further for proper divergence
-  std::vector<std::string> reasons;
+  std::pmr::vector<std::string> reasons{scratch()};
 
   // Find recent low in price
   int price_low_idx = idx;
@@ -92,7 +93,7 @@ Hint rsi_bullish_divergence(const IndicatorsTrends& ind, int idx) {
 
 Hint macd_bullish_divergence(const IndicatorsTrends& ind, int idx) {
   const int LOOKBACK = 15;  // Longer lookback for MACD divergence
-  std::vector<std::string> reasons;
+  std::pmr::vector<std::string> reasons{scratch()};
 
   // Find recent low in price
   int price_low_idx = idx;
@@ -168,7 +169,7 @@ Hint macd_bullish_divergence(const IndicatorsTrends& ind, int idx) {
 
 Hint rsi_bearish_divergence(const IndicatorsTrends& ind, int idx) {
   const int LOOKBACK = 10;
-  std::vector<std::string> reasons;
+  std::pmr::vector<std::string> reasons{scratch()};
 
   // Find recent high in price
   int price_high_idx = idx;
@@ -1,11 +1,12 @@
 #include "ind/indicators.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 
 Hint ema_flattens_hint(const IndicatorsTrends& m, int idx) {
   double score = 1.0;
 
   // Analyze EMA9 slope over multiple periods
-  std::vector<double> slopes;
+  std::pmr::vector<double> slopes{scratch()};
   for (int i = idx - 5; i <= idx && i > 0; i++)
     slopes.push_back((m.ema9(i) - m.ema9(i - 1)) / m.ema9(i));
   if (slopes.empty())
@@ -1,5 +1,7 @@
 #include "ind/indicators.h"
+#include "sig/rule_profile.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 #include "util/config.h"
 
 inline auto& sig_config = config.sig_config;
@@ -45,8 +47,30 @@ inline constexpr hint_f hint_funcs[] = {
     near_support_resistance_hint,
 };
 
+// names for the rule profile, in the order of hint_funcs
+inline constexpr const char* hint_names[] = {
+    "ema_converging_hint",
+    "rsi_approaching_50_hint",
+    "macd_histogram_rising_hint",
+    "price_pullback_hint",
+    "rsi_bullish_divergence",
+    "macd_bullish_divergence",
+    "ema_diverging_hint",
+    "rsi_falling_from_overbought_hint",
+    "macd_histogram_peaking_hint",
+    "ema_flattens_hint",
+    "rsi_bearish_divergence",
+    "near_support_resistance_hint",
+};
+static_assert(std::size(hint_names) == std::size(hint_funcs));
+
+inline size_t hint_rule(size_t k) {
+  static const auto first = rule_profiler.add("hint", hint_names);
+  return first + k;
+}
+
 // Check for conflicting hints and apply penalties
-inline void check_conflicts(std::vector<Hint>& hints) {
+inline void check_conflicts(std::pmr::vector<Hint>& hints) {
   // Find conflicting pairs
   bool has_ema_conv = false, has_ema_div = false;
   bool has_rsi_bull = false, has_rsi_bear = false;
@@ -89,10 +113,12 @@ inline void check_conflicts(std::vector<Hint>& hints) {
   }
 }
 
-std::vector<Hint> hints(const IndicatorsTrends& ind, int idx) {
-  std::vector<Hint> res;
-  for (auto f : hint_funcs) {
-    auto hint = f(ind, idx);
+// scratch, Evidence copies out the ones it keeps
+std::pmr::vector<Hint> hints(const IndicatorsTrends& ind, int idx) {
+  std::pmr::vector<Hint> res{scratch()};
+  for (size_t k = 0; k < std::size(hint_funcs); k++) {
+    auto prof = rule_profiler.slot(hint_rule(k), RulePath::Live, ind.interval);
+    auto hint = profiled(prof, hint_funcs[k], ind, idx);
     if (hint.type != HintType::None)
       res.push_back(hint);
   }
@@ -106,8 +132,10 @@ std::vector<Hint> hints(const IndicatorsTrends& ind, int idx) {
 // Keep the Stats::get_hint_stats function as is
 std::map<HintType, SignalStats> Stats::get_hint_stats(const Backtest& bt) {
   std::map<HintType, SignalStats> hint;
-  for (auto& f : hint_funcs) {
-    auto [h, s] = bt.get_stats<HintType>(f);
+  for (size_t k = 0; k < std::size(hint_funcs); k++) {
+    auto prof = rule_profiler.slot(hint_rule(k), RulePath::Backtest,
+                                   bt.interval());
+    auto [h, s] = bt.get_stats<HintType>(hint_funcs[k], prof);
     hint.try_emplace(h, s);
   }
   return hint;
@@ -1,5 +1,6 @@
 #include "ind/indicators.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 
 Hint macd_histogram_peaking_hint(const IndicatorsTrends& m, int idx) {
   // Basic peak pattern check
@@ -10,7 +11,7 @@ Hint macd_histogram_peaking_hint(const IndicatorsTrends& m, int idx) {
   double peak_height = m.hist(idx - 1);
 
   // Find previous peaks for comparison
-  std::vector<double> previous_peaks;
+  std::pmr::vector<double> previous_peaks{scratch()};
   for (int i = idx - 15; i < idx - 3 && i > 0; i++) {
     if (m.hist(i - 1) < m.hist(i) && m.hist(i) > m.hist(i + 1))
       previous_peaks.push_back(m.hist(i));
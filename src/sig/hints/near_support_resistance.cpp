@@ -1,5 +1,6 @@
 #include "ind/indicators.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 #include "util/config.h"
 #include "util/format.h"
 
@@ -9,7 +10,7 @@ Hint near_support_resistance_hint(const IndicatorsTrends& ind, int idx) {
   auto price = ind.price(idx);
   auto support_opt = ind.nearest_support_below(idx);
   auto resistance_opt = ind.nearest_resistance_above(idx);
-  std::vector<std::string> reasons;
+  std::pmr::vector<std::string> reasons{scratch()};
 
   if (!support_opt && !resistance_opt)
     return HintType::None;
@@ -1,5 +1,6 @@
 #include "ind/indicators.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 #include "util/config.h"
 #include "util/format.h"
 
@@ -8,7 +9,7 @@ inline auto& sig_config = config.sig_config;
 Reason broke_support_exit(const IndicatorsTrends& ind, int idx) {
   double current_close = ind.price(idx);
   double prev_close = ind.price(idx - 1);
-  std::vector<std::string> reasons;
+  std::pmr::vector<std::string> reasons{scratch()};
 
   // Get the nearest support above current price (the one we just broke)
   auto support_above = ind.nearest_support_above(idx);
@@ -1,5 +1,6 @@
 #include "ind/indicators.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 #include "util/config.h"
 #include "util/format.h"
 
@@ -9,7 +10,7 @@ Reason ema_crossdown_exit(const IndicatorsTrends& ind, int idx) {
   const int LOOKBACK = sig_config.ema_cross_lookback;
   int cross_idx = idx;
   double score = 1.0;
-  std::vector<std::string> reasons;
+  std::pmr::vector<std::string> reasons{scratch()};
 
   // Find the crossdown
   for (; cross_idx > idx - LOOKBACK; cross_idx--) {
@@ -1,5 +1,6 @@
 #include "ind/indicators.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 #include "util/config.h"
 #include "util/format.h"
 
@@ -12,7 +13,7 @@ Reason pullback_bounce_entry(const IndicatorsTrends& ind, int idx) {
 
   const int LOOKBACK = sig_config.pullback_bounce_lookback;
   const int MAX_PULLBACK_SCAN = sig_config.pullback_scan_lookback;
-  std::vector<std::string> reasons;
+  std::pmr::vector<std::string> reasons{scratch()};
 
   // Find most recent pullback candle (price < ema21) within lookback
   bool found = false;
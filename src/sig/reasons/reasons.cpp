@@ -1,5 +1,7 @@
 #include "ind/indicators.h"
+#include "sig/rule_profile.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 #include "util/config.h"
 
 inline auto& sig_config = config.sig_config;
@@ -27,8 +29,26 @@ inline constexpr signal_f reason_funcs[] = {
     broke_support_exit,
 };
 
+// names for the rule profile, in the order of reason_funcs
+inline constexpr const char* reason_names[] = {
+    "ema_crossover_entry",
+    "rsi_cross_50_entry",
+    "pullback_bounce_entry",
+    "macd_histogram_cross_entry",
+    "broke_resistance_entry",
+    "ema_crossdown_exit",
+    "macd_bearish_cross_exit",
+    "broke_support_exit",
+};
+static_assert(std::size(reason_names) == std::size(reason_funcs));
+
+inline size_t reason_rule(size_t k) {
+  static const auto first = rule_profiler.add("reason", reason_names);
+  return first + k;
+}
+
 // Check for conflicting reasons and apply penalties
-inline void check_conflicts(std::vector<Reason>& reasons) {
+inline void check_conflicts(std::pmr::vector<Reason>& reasons) {
   if (reasons.size() < 2)
     return;
 
@@ -94,10 +114,13 @@ inline void check_conflicts(std::vector<Reason>& reasons) {
   }
 }
 
-std::vector<Reason> reasons(const IndicatorsTrends& ind, int idx) {
-  std::vector<Reason> res;
-  for (auto f : reason_funcs) {
-    auto reason = f(ind, idx);
+// scratch, Evidence copies out the ones it keeps
+std::pmr::vector<Reason> reasons(const IndicatorsTrends& ind, int idx) {
+  std::pmr::vector<Reason> res{scratch()};
+  for (size_t k = 0; k < std::size(reason_funcs); k++) {
+    auto prof = rule_profiler.slot(reason_rule(k), RulePath::Live,
+                                   ind.interval);
+    auto reason = profiled(prof, reason_funcs[k], ind, idx);
     if (reason.type != ReasonType::None) {
       res.push_back(reason);
     }
@@ -108,8 +131,10 @@ std::vector<Reason> reasons(const IndicatorsTrends& ind, int idx) {
 
 std::map<ReasonType, SignalStats> Stats::get_reason_stats(const Backtest& bt) {
   std::map<ReasonType, SignalStats> reason;
-  for (auto& f : reason_funcs) {
-    auto [r, s] = bt.get_stats<ReasonType>(f);
+  for (size_t k = 0; k < std::size(reason_funcs); k++) {
+    auto prof = rule_profiler.slot(reason_rule(k), RulePath::Backtest,
+                                   bt.interval());
+    auto [r, s] = bt.get_stats<ReasonType>(reason_funcs[k], prof);
     reason.try_emplace(r, s);
   }
   return reason;
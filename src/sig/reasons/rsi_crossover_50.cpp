@@ -1,5 +1,6 @@
 #include "ind/indicators.h"
 #include "sig/signals.h"
+#include "util/arena.h"
 #include "util/config.h"
 #include "util/format.h"
 
@@ -16,7 +17,7 @@ Reason rsi_cross_50_entry(const IndicatorsTrends& ind, int idx) {
 
   int cross_idx = idx;
   double score = 1.0;
-  std::vector<std::string> reasons;
+  std::pmr::vector<std::string> reasons{scratch()};
 
   // Find the cross
   for (; cross_idx > idx - LOOKBACK; cross_idx--) {
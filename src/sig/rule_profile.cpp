@@ -0,0 +1,126 @@
+#include "sig/rule_profile.h"
+
+#include <algorithm>
+#include <bit>
+
+inline size_t ns_bucket(uint64_t ns) {
+  if (ns < RuleStats::N_SUB)
+    return ns;
+
+  // the top bit picks the octave, the two below it the sub-bucket
+  auto width = static_cast<size_t>(std::bit_width(ns));
+  auto sub = (ns >> (width - 3)) & (RuleStats::N_SUB - 1);
+  auto i = (width - 2) * RuleStats::N_SUB + sub;
+  return std::min(i, RuleStats::N_BUCKETS - 1);
+}
+
+// smallest value of a bucket, the inverse of ns_bucket
+inline double ns_floor(size_t i) {
+  if (i < RuleStats::N_SUB)
+    return static_cast<double>(i);
+  auto width = i / RuleStats::N_SUB + 2;
+  auto sub = i % RuleStats::N_SUB;
+  return static_cast<double>((RuleStats::N_SUB + sub) << (width - 3));
+}
+
+void RuleStats::add(uint64_t t_ns, bool fired, uint64_t n_allocs) {
+  calls.fetch_add(1, std::memory_order_relaxed);
+  fires.fetch_add(fired, std::memory_order_relaxed);
+  ns.fetch_add(t_ns, std::memory_order_relaxed);
+  allocs.fetch_add(n_allocs, std::memory_order_relaxed);
+  hist[ns_bucket(t_ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+double RuleStats::p99_ns() const {
+  auto n = calls.load(std::memory_order_relaxed);
+  if (n == 0)
+    return 0.0;
+
+  // the first bucket holding the 99th percentile call, read as its lower
+  // bound
+  auto rank = n - n / 100;
+  uint64_t cum = 0;
+  for (size_t i = 0; i < N_BUCKETS; i++) {
+    cum += hist[i].load(std::memory_order_relaxed);
+    if (cum >= rank)
+      return ns_floor(i);
+  }
+  return ns_floor(N_BUCKETS - 1);
+}
+
+size_t RuleProfiler::tf_idx(minutes tf) {
+  if (tf == H_1)
+    return 0;
+  if (tf == H_4)
+    return 1;
+  if (tf == D_1)
+    return 2;
+  return 3;
+}
+
+inline constexpr minutes tf_of[] = {H_1, H_4, D_1, minutes{0}};
+
+void RuleProfiler::enable(bool en) {
+  std::lock_guard _{mtx};
+  if (en && !stats)
+    stats = std::make_unique<std::array<RuleStats, N_SLOTS>>();
+  on.store(en, std::memory_order_release);
+}
+
+size_t RuleProfiler::add(const char* kind,
+                         std::span<const char* const> rule_names) {
+  std::lock_guard _{mtx};
+  auto first = n_rules;
+  for (auto name : rule_names) {
+    if (n_rules == MAX_RULES)
+      break;
+    kinds[n_rules] = kind;
+    names[n_rules] = name;
+    n_rules++;
+  }
+  return first;
+}
+
+RuleStats* RuleProfiler::slot(size_t rule, RulePath path, minutes tf) {
+  if (!enabled() || rule >= MAX_RULES)
+    return nullptr;
+  auto p = static_cast<size_t>(path);
+  return &(*stats)[(rule * 2 + p) * N_TIMEFRAMES + tf_idx(tf)];
+}
+
+std::vector<RuleRow> RuleProfiler::rows() {
+  std::vector<RuleRow> res;
+
+  std::lock_guard _{mtx};
+  if (!stats)
+    return res;
+
+  for (size_t rule = 0; rule < n_rules; rule++) {
+    for (size_t p = 0; p < 2; p++) {
+      for (size_t tf = 0; tf < N_TIMEFRAMES; tf++) {
+        auto& s = (*stats)[(rule * 2 + p) * N_TIMEFRAMES + tf];
+        auto calls = s.calls.load(std::memory_order_relaxed);
+        if (calls == 0)
+          continue;
+
+        auto ns = static_cast<double>(s.ns.load(std::memory_order_relaxed));
+        res.push_back({
+            .kind = kinds[rule],
+            .name = names[rule],
+            .path = static_cast<RulePath>(p),
+            .timeframe = tf_of[tf],
+            .calls = calls,
+            .fire_rate = double(s.fires.load()) / calls,
+            .total_ms = ns / 1e6,
+            .avg_ns = ns / calls,
+            .p99_ns = s.p99_ns(),
+            .allocs_per_call = double(s.allocs.load()) / calls,
+        });
+      }
+    }
+  }
+
+  std::sort(res.begin(), res.end(),
+            [](auto& l, auto& r) { return l.total_ms > r.total_ms; });
+  return res;
+}
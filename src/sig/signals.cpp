@@ -1,11 +1,12 @@
 #include "ind/indicators.h"
+#include "util/arena.h"
 #include "util/config.h"
 
 #include <spdlog/spdlog.h>
 #include <cmath>
 
-std::vector<Reason> reasons(const IndicatorsTrends& ind, int idx);
-std::vector<Hint> hints(const IndicatorsTrends& ind, int idx);
+std::pmr::vector<Reason> reasons(const IndicatorsTrends& ind, int idx);
+std::pmr::vector<Hint> hints(const IndicatorsTrends& ind, int idx);
 
 bool Signal::is_interesting() const {
   if (type == Rating::Entry || type == Rating::Exit ||
@@ -22,29 +23,27 @@ bool Signal::is_interesting() const {
   return important(reasons) || important(hints);
 }
 
-inline auto& sig_config = config.sig_config;
-
-inline Rating gen_rating(double entry_w,
-                         double exit_w,
-                         auto& reasons,
-                         auto& hints) {
+Rating Evidence::rate(double entry_w,
+                      double exit_w,
+                      const SignalConfig& cfg) const {
   // 1. Strong Entry
-  if (entry_w >= sig_config.entry_threshold &&
-      exit_w <= sig_config.watchlist_threshold && !reasons.empty())
+  if (entry_w >= cfg.entry_threshold && exit_w <= cfg.watchlist_threshold &&
+      !reasons.empty())
     return Rating::Entry;
 
   // 2. Strong Exit
-  if (exit_w >= sig_config.exit_threshold &&
-      entry_w <= sig_config.watchlist_threshold && !reasons.empty())
+  if (exit_w >= cfg.exit_threshold && entry_w <= cfg.watchlist_threshold &&
+      !reasons.empty())
     return Rating::Exit;
 
   // 3. Mixed
-  if (entry_w >= sig_config.mixed_min && exit_w >= sig_config.mixed_min)
+  if (entry_w >= cfg.mixed_min && exit_w >= cfg.mixed_min)
     return Rating::Mixed;
 
   // 4. Moderate Exit or urgent exit hint
   bool has_urgent_exit_hint =
-      std::any_of(hints.begin(), hints.end(), [](auto& h) {
+      std::any_of(hints.begin(), hints.end(), [](auto& p) {
+        auto& h = p.first;
         return h.cls() == SignalClass::Exit && h.severity() == Severity::Urgent;
       });
 
@@ -52,10 +51,10 @@ inline Rating gen_rating(double entry_w,
     return Rating::Caution;
 
   // 5. Entry bias
-  if (entry_w >= sig_config.watchlist_threshold)
+  if (entry_w >= cfg.watchlist_threshold)
     return Rating::Watchlist;
 
-  if (exit_w >= sig_config.watchlist_threshold)
+  if (exit_w >= cfg.watchlist_threshold)
     return Rating::Caution;
 
   // // 6. Fallbacks
@@ -81,59 +80,69 @@ inline Rating gen_rating(double entry_w,
   return Rating::None;
 }
 
-inline Score gen_score(double entry_w, double exit_w) {
-  auto weight = sig_config.score_entry_weight;
+Score gen_score(double entry_w, double exit_w, const SignalConfig& cfg) {
+  auto weight = cfg.score_entry_weight;
   auto net = entry_w * weight - exit_w * (1 - weight);
-  double net_score = std::tanh(net * sig_config.score_squash_factor);
+  double net_score = std::tanh(net * cfg.score_squash_factor);
   return {entry_w, exit_w, net_score};
 }
 
-Signal::Signal(const Indicators& ind, int idx) {
-  tp = ind.time(idx);
-
-  double entry_w = 0.0, exit_w = 0.0;
-  auto add_w = [&entry_w, &exit_w](auto r, auto w, double gw = 1) {
-    if (w <= 0.02 || w >= 0.98)  // ignore extremes
-      return;
-    auto r_w = r.severity_w() * r.score * gw;
-    if (r.cls() == SignalClass::Entry)
-      entry_w += w * r_w;
-    else if (r.cls() == SignalClass::Exit)
-      exit_w += (1 - w) * r_w;
-  };
-
+Evidence::Evidence(const Indicators& ind, int idx) {
   auto& stats = ind.stats;
 
   // Hard signals
-  for (auto r : ::reasons(ind, idx)) {
+  for (auto& r : ::reasons(ind, idx)) {
     if (r.type == ReasonType::None || r.cls() == SignalClass::None)
       continue;
-    reasons.emplace_back(r);
 
     auto imp = 0.0;
     if (auto it = stats.reason.find(r.type); it != stats.reason.end())
       imp = it->second.imp;
-    if (r.source() == Source::Stop)
-      imp = sig_config.stop_reason_importance;
-
-    add_w(r, imp);
+    reasons.emplace_back(r, imp);
   }
 
   // Hints
-  for (auto h : ::hints(ind, idx)) {
+  for (auto& h : ::hints(ind, idx)) {
     if (h.type == HintType::None || h.cls() == SignalClass::None)
       continue;
 
-    hints.emplace_back(h);
-
     auto imp = 0.0;
     if (auto it = stats.hint.find(h.type); it != stats.hint.end())
       imp = it->second.imp;
-    if (h.source() == Source::Stop)
-      imp = sig_config.stop_hint_importance;
-
-    add_w(h, imp, sig_config.score_hint_weight);
+    hints.emplace_back(h, imp);
   }
+}
+
+std::pair<double, double> Evidence::weigh(const SignalConfig& cfg) const {
+  double entry_w = 0.0, exit_w = 0.0;
+  auto add_w = [&entry_w, &exit_w](auto& r, auto w, double gw = 1) {
+    if (w <= 0.02 || w >= 0.98)  // ignore extremes
+      return;
+    auto r_w = r.severity_w() * r.score * gw;
+    if (r.cls() == SignalClass::Entry)
+      entry_w += w * r_w;
+    else if (r.cls() == SignalClass::Exit)
+      exit_w += (1 - w) * r_w;
+  };
+
+  for (auto& [r, imp] : reasons)
+    add_w(r, r.source() == Source::Stop ? cfg.stop_reason_importance : imp);
+
+  for (auto& [h, imp] : hints)
+    add_w(h, h.source() == Source::Stop ? cfg.stop_hint_importance : imp,
+          cfg.score_hint_weight);
+
+  return {entry_w, exit_w};
+}
+
+Signal::Signal(const Indicators& ind, int idx) {
+  tp = ind.time(idx);
+
+  Evidence ev{ind, idx};
+  for (auto& [r, _] : ev.reasons)
+    reasons.push_back(r);
+  for (auto& [h, _] : ev.hints)
+    hints.push_back(h);
 
   auto sort = [](auto& v) {
     std::sort(v.begin(), v.end(), [](auto& lhs, auto& rhs) {
@@ -144,8 +153,10 @@ Signal::Signal(const Indicators& ind, int idx) {
   sort(reasons);
   sort(hints);
 
-  type = gen_rating(entry_w, exit_w, reasons, hints);
-  score = gen_score(entry_w, exit_w);
+  auto& sig_config = config.sig_config;
+  auto [entry_w, exit_w] = ev.weigh(sig_config);
+  type = ev.rate(entry_w, exit_w, sig_config);
+  score = gen_score(entry_w, exit_w, sig_config);
 
   forecast = Forecast{ind.interval, *this, ind.stats};
 }
@@ -0,0 +1,114 @@
+#include "util/alloc_hook.h"
+#include "util/telemetry.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// plain thread locals, so counting costs an increment and no contention
+inline thread_local uint64_t n_thread_allocs = 0;
+inline thread_local uint64_t n_thread_bytes = 0;
+
+uint64_t thread_allocs() noexcept {
+  return n_thread_allocs;
+}
+
+uint64_t thread_alloc_bytes() noexcept {
+  return n_thread_bytes;
+}
+
+void rewind_thread_allocs(uint64_t count, uint64_t bytes) noexcept {
+  n_thread_allocs = count;
+  n_thread_bytes = bytes;
+}
+
+void* operator new(size_t sz) {
+  n_thread_allocs++;
+  n_thread_bytes += sz;
+  if (auto s = alloc_stage) {
+    s->count.fetch_add(1, std::memory_order_relaxed);
+    s->bytes.fetch_add(sz, std::memory_order_relaxed);
+  }
+  if (auto p = std::malloc(sz ? sz : 1))
+    return p;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+// names are string literals, which may differ in address across translation
+// units, so they're compared by content. must not allocate, it runs inside
+// Span constructors that operator new may be charging
+AllocStage* AllocStats::stage(const char* name) noexcept {
+  for (auto& s : stages) {
+    auto cur = s.name.load(std::memory_order_acquire);
+    if (cur == nullptr && s.name.compare_exchange_strong(
+                              cur, name, std::memory_order_acq_rel))
+      return &s;
+    if (cur == name || std::strcmp(cur, name) == 0)
+      return &s;
+  }
+  return nullptr;
+}
+
+void AllocStats::report() {
+  struct Row {
+    const char* name;
+    uint64_t count;
+    uint64_t bytes;
+  };
+
+  UncountedAllocs uncounted;
+
+  std::vector<Row> rows;
+  {
+    std::lock_guard _{mtx};
+    for (auto& s : stages) {
+      auto name = s.name.load(std::memory_order_acquire);
+      if (name == nullptr)
+        break;
+
+      auto count = s.count.load(std::memory_order_relaxed);
+      auto bytes = s.bytes.load(std::memory_order_relaxed);
+      rows.push_back({name, count - s.last_count, bytes - s.last_bytes});
+      s.last_count = count;
+      s.last_bytes = bytes;
+    }
+  }
+
+  std::sort(rows.begin(), rows.end(),
+            [](auto& l, auto& r) { return l.bytes > r.bytes; });
+
+  uint64_t total = 0, total_bytes = 0;
+  for (auto& r : rows) {
+    total += r.count;
+    total_bytes += r.bytes;
+  }
+  spdlog::info("[alloc] update: {} allocs, {:.1f} KB", total,
+               total_bytes / 1024.0);
+
+  for (auto& r : rows) {
+    telemetry
+        .counter("fin_allocs_total", "Heap allocations by stage",
+                 {{"stage", r.name}})
+        .inc(r.count);
+    telemetry
+        .counter("fin_alloc_bytes_total", "Heap bytes allocated by stage",
+                 {{"stage", r.name}})
+        .inc(r.bytes);
+
+    if (r.count > 0)
+      spdlog::info("[alloc]   {}: {} allocs, {:.1f} KB", r.name, r.count,
+                    r.bytes / 1024.0);
+  }
+}
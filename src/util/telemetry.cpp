@@ -0,0 +1,119 @@
+#include "util/telemetry.h"
+
+#include <cmath>
+#include <format>
+#include <limits>
+
+double Histogram::upper_bound(size_t i) {
+  if (i + 1 >= N_BUCKETS)
+    return std::numeric_limits<double>::infinity();
+  auto octave = static_cast<int>(i / N_SUB);
+  auto sub = static_cast<int>(i % N_SUB);
+  return std::ldexp(1.0 + double(sub + 1) / N_SUB, MIN_EXP + octave);
+}
+
+size_t Histogram::bucket_of(double ms) {
+  if (!(ms > std::ldexp(1.0, MIN_EXP)))
+    return 0;
+
+  // ms = (2 * frac) * 2^(exp - 1), with 2 * frac in [1, 2). bounds are
+  // inclusive, so a power of two is the top of the octave below
+  int exp = 0;
+  auto frac = std::frexp(ms, &exp);
+  auto octave = exp - 1 - MIN_EXP;
+  auto sub = static_cast<int>(std::ceil((2 * frac - 1) * N_SUB)) - 1;
+  auto i = static_cast<size_t>(std::max(octave * N_SUB + sub, 0));
+  return std::min(i, N_BUCKETS - 1);
+}
+
+void Histogram::observe(double ms) {
+  counts[bucket_of(ms)].fetch_add(1, std::memory_order_relaxed);
+  n.fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(ms, std::memory_order_relaxed);
+}
+
+inline std::string render(const Labels& labels) {
+  std::string res;
+  for (auto& [k, v] : labels)
+    res += std::format("{}{}=\"{}\"", res.empty() ? "" : ",", k, v);
+  return res;
+}
+
+template <typename T>
+T& Telemetry::get(std::map<std::string, Family<T>>& families,
+                  const std::string& name,
+                  const std::string& help,
+                  const Labels& labels) {
+  std::lock_guard _{mtx};
+  auto& family = families[name];
+  if (family.help.empty())
+    family.help = help;
+  auto& p = family.series[render(labels)];
+  if (!p)
+    p = std::make_unique<T>();
+  return *p;
+}
+
+Counter& Telemetry::counter(const std::string& name,
+                            const std::string& help,
+                            const Labels& labels) {
+  return get(counters, name, help, labels);
+}
+
+Gauge& Telemetry::gauge(const std::string& name,
+                        const std::string& help,
+                        const Labels& labels) {
+  return get(gauges, name, help, labels);
+}
+
+Histogram& Telemetry::histogram(const std::string& name,
+                                const std::string& help,
+                                const Labels& labels) {
+  return get(histograms, name, help, labels);
+}
+
+inline std::string braced(const std::string& labels) {
+  return labels.empty() ? "" : "{" + labels + "}";
+}
+
+inline std::string le(double bound) {
+  return std::isinf(bound) ? "+Inf" : std::format("{}", bound);
+}
+
+std::string Telemetry::expose() {
+  std::lock_guard _{mtx};
+  std::string out;
+
+  auto header = [&](auto& name, auto& help, auto type) {
+    out += std::format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+  };
+
+  for (auto& [name, f] : counters) {
+    header(name, f.help, "counter");
+    for (auto& [labels, c] : f.series)
+      out += std::format("{}{} {}\n", name, braced(labels), c->value());
+  }
+
+  for (auto& [name, f] : gauges) {
+    header(name, f.help, "gauge");
+    for (auto& [labels, g] : f.series)
+      out += std::format("{}{} {}\n", name, braced(labels), g->value());
+  }
+
+  for (auto& [name, f] : histograms) {
+    header(name, f.help, "histogram");
+    for (auto& [labels, h] : f.series) {
+      auto sep = labels.empty() ? "" : ",";
+      uint64_t cum = 0;
+      for (size_t i = 0; i < Histogram::N_BUCKETS; i++) {
+        cum += h->bucket(i);
+        out += std::format("{}_bucket{{{}{}le=\"{}\"}} {}\n", name, labels,
+                           sep, le(Histogram::upper_bound(i)), cum);
+      }
+      out += std::format("{}_sum{} {}\n", name, braced(labels), h->total());
+      out += std::format("{}_count{} {}\n", name, braced(labels), cum);
+    }
+  }
+
+  return out;
+}
@@ -122,10 +122,12 @@ std::string to_str<FormatTarget::Telegram>(const Ticker& ticker) {
       "{} \"{}\" {}\n\n"  //
       "{}"                //
       "{}\n"
+      "{}\n"
       "{}\n",                                   //
       emoji(signal.type), symbol, pos_line,     //
       to_str<FormatTarget::Telegram>(metrics),  //
       stop_line,
+      to_str<FormatTarget::Telegram>(signal.rationale, signal),
       to_str<FormatTarget::Telegram>(ind.signal)  //
   );
 }
@@ -34,11 +34,16 @@ std::string datetime_to_string(LocalTimePoint tp) {
   return std::format("{:%F %T}", tp);
 }
 
-LocalTimePoint now_ny_time() {
+LocalTimePoint wall_ny_time() {
   zoned_time now_zt{ny_tz, system_clock::now()};
   return floor<seconds>(now_zt.get_local_time());
 }
 
+LocalTimePoint MarketClock::now() const {
+  auto t = pinned.load();
+  return t == LIVE ? wall_ny_time() : LocalTimePoint{seconds{t}};
+}
+
 SysTimePoint now_utc_time(std::string_view timezone) {
   const auto& db = get_tzdb();
   const auto* tz = db.locate_zone(std::string(timezone));
@@ -106,6 +111,16 @@ std::pair<bool, minutes> market_status(minutes interval) {
   return {false, minutes{-1}};
 }
 
+bool is_market_hours(LocalTimePoint tp) {
+  auto today = floor<days>(tp);
+  weekday wd{today};
+  if (wd == Saturday || wd == Sunday)
+    return false;
+
+  auto time_of_day = tp - today;
+  return time_of_day >= hours{9} + minutes{30} && time_of_day < hours{16};
+}
+
 bool last_candle_in_interval(minutes interval, LocalTimePoint tp) {
   auto start_of_day = floor<days>(tp) + hours{9} + minutes{30};
   auto time_of_day = floor<minutes>(tp - start_of_day);
@@ -0,0 +1,88 @@
+#include "util/trace.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+int64_t Tracer::now_ns() {
+  using namespace std::chrono;
+  // offset by one so a span never starts at 0, which means not recording
+  static const auto epoch = steady_clock::now() - nanoseconds{1};
+  return duration_cast<nanoseconds>(steady_clock::now() - epoch).count();
+}
+
+Tracer::Buffer& Tracer::local() {
+  thread_local std::shared_ptr<Buffer> buf;
+  if (!buf) {
+    buf = std::make_shared<Buffer>();
+    std::lock_guard _{mtx};
+    buf->tid = next_tid++;
+    buffers.push_back(buf);
+  }
+  return *buf;
+}
+
+void Tracer::record(const char* name,
+                    std::string&& arg,
+                    int64_t start_ns,
+                    int64_t dur_ns) {
+  UncountedAllocs uncounted;
+  auto& buf = local();
+  std::lock_guard _{buf.mtx};
+  buf.events.push_back({name, std::move(arg), start_ns, dur_ns});
+}
+
+bool Tracer::dump(const std::string& dir) {
+  UncountedAllocs uncounted;
+
+  std::vector<std::pair<uint32_t, std::vector<Event>>> all;
+  size_t n = 0;
+  {
+    std::lock_guard _{mtx};
+    for (auto& buf : buffers) {
+      std::lock_guard _{buf->mtx};
+      if (!buf->events.empty())
+        all.emplace_back(buf->tid, std::move(buf->events));
+      buf->events.clear();
+    }
+
+    // pool threads live for one cycle, their buffers go with the last dump
+    std::erase_if(buffers, [](auto& buf) { return buf.use_count() == 1; });
+    n = n_dumps++;
+  }
+
+  std::error_code ec;
+  fs::create_directories(dir, ec);
+
+  auto fname = std::format("{}/trace_{:05}.json", dir, n);
+  std::ofstream ofs{fname, std::ios::trunc};
+
+  ofs << "{\"traceEvents\":[";
+  bool first = true;
+  for (auto& [tid, events] : all) {
+    for (auto& e : events) {
+      ofs << (first ? "\n" : ",\n");
+      first = false;
+      ofs << std::format(
+          "{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},"
+          "\"pid\":1,\"tid\":{}",
+          e.name, e.start_ns / 1e3, e.dur_ns / 1e3, tid);
+      if (!e.arg.empty())
+        ofs << std::format(",\"args\":{{\"symbol\":\"{}\"}}", e.arg);
+      ofs << "}";
+    }
+  }
+  ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+  if (!ofs) {
+    spdlog::error("[trace] error writing {}", fname.c_str());
+    return false;
+  }
+  return true;
+}
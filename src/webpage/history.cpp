@@ -1,9 +1,9 @@
 #include "core/portfolio.h"
 #include "util/format.h"
+#include "util/telemetry.h"
+#include "util/trace.h"
 
-#include <fstream>
 #include <set>
-#include <thread>
 
 constexpr std::string_view history_template = R"(
 <!DOCTYPE html>
@@ -148,18 +148,28 @@ inline std::string to_str<FormatTarget::HTML>(const Tickers& tickers,
 }
 
 void Portfolio::write_history() const {
-  std::thread([this]() {
+  write_async([this] {
+    Span span{"page", "history"};
+    static auto& hist = telemetry.histogram(
+        "fin_page_write_ms", "Time to render and write a page",
+        {{"page", "history"}});
+    Timed t{hist};
     auto _ = reader_lock();
 
+    // every ticker feeds every table, so any of them moving re-renders all
+    uint64_t stamp = 0;
+    for (auto& [symbol, ticker] : tickers)
+      stamp = mix(stamp, ticker.version);
+    if (history_stamp == stamp)
+      return;
+
     auto tbl_1h = to_str<FormatTarget::HTML>(tickers, H_1);
     auto tbl_4h = to_str<FormatTarget::HTML>(tickers, H_4);
     auto tbl_1d = to_str<FormatTarget::HTML>(tickers, D_1);
 
     auto history = std::format(history_template, tbl_1h, tbl_4h, tbl_1d);
 
-    std::ofstream f(std::format("page/public/history.html"));
-    f << history;
-    f.flush();
-    f.close();
-  }).detach();
+    if (write_if_changed("page/public/history.html", history))
+      history_stamp = stamp;
+  });
 }
@@ -1,10 +1,11 @@
 #include "core/portfolio.h"
 #include "gen_html_template.h"
+#include "sig/rule_profile.h"
 #include "util/format.h"
+#include "util/telemetry.h"
+#include "util/trace.h"
 
 #include <filesystem>
-#include <fstream>
-#include <thread>
 
 inline constexpr std::string_view index_subtitle_template = R"(
     <div id="title">Portfolio Overview</div>
@@ -23,7 +24,7 @@ inline constexpr std::string_view index_subtitle_template = R"(
       </div>
       <div class="update-block">
         <a href="positions.html" target="_blank"><b>Positions</b></a>
-      </div>
+      </div>{}
       <div class="update-block">
         <b>Earnings:</b> 
           <a href="https://finance.yahoo.com/calendar/earnings/" target="_blank">Yahoo</a>
@@ -36,6 +37,11 @@ inline constexpr std::string_view index_subtitle_template = R"(
     </div>
 )";
 
+inline constexpr std::string_view index_rules_link = R"(
+      <div class="update-block">
+        <a href="rules.html" target="_blank"><b>Rules</b></a>
+      </div>)";
+
 inline constexpr std::string_view index_event_template = R"(
   <a href="https://finance.yahoo.com/quote/{}/analysis/" 
      target="_blank">
@@ -184,9 +190,17 @@ std::string to_str<FormatTarget::HTML>(const Signal& s, const Source& src) {
   return interesting;
 }
 
+// the event cell reads the ticker's event and counts the days to it, neither
+// of which moves the ticker version
+inline uint64_t event_stamp(const Event& ev, LocalTimePoint today) {
+  uint64_t h = mix(ev.type, ev.date.time_since_epoch().count());
+  return mix(h, today.time_since_epoch().count());
+}
+
 template <>
 inline std::string to_str<FormatTarget::HTML>(const Portfolio& p) {
   std::string body;
+  auto today = today_ny();
 
   std::vector<std::pair<const std::string*, const Ticker*>> sorted;
   for (auto& [symbol, ticker] : p.tickers)
@@ -202,65 +216,77 @@ inline std::string to_str<FormatTarget::HTML>(const Portfolio& p) {
     auto& symbol = *s;
     auto& ticker = *t;
 
-    auto& m = ticker.metrics;
-    auto& ind_1h = m.ind_1h;
-
-    auto& sig = ticker.signal;
-    auto& sig_1h = ind_1h.signal;
-
-    auto stop_str = sig.stop_hit.str();
-    auto str = [&](auto src) {
-      return to_str<FormatTarget::HTML>(sig_1h, src);
-    };
-
-    body += std::format(                                                      //
-        index_row_template,                                                   //
-        symbol,                                                               //
-        to_str<FormatTarget::HTML>(sig.type),                                 //
-        hide(m, sig.type) ? "display:none;" : "",                             //
-        to_str<FormatTarget::HTML>(sig),                                      //
-        ticker.si.priority == 3 ? symbol : std::format("<b>{}</b>", symbol),  //
-        to_str<FormatTarget::HTML>(symbol, ticker.ev),                        //
-        str(Source::Price) + stop_str + str(Source::SR),                      //
-        str(Source::EMA),                                                     //
-        str(Source::RSI),                                                     //
-        str(Source::MACD),                                                    //
-        to_str<FormatTarget::HTML>(m.position, m.last_price()),               //
-        to_str<FormatTarget::HTML>(m, ticker.risk.stop_loss,                  //
-                                   ticker.risk.target)                        //
-    );
-
-    auto overview = std::format(                            //
-        signal_overview_template,                           //
-        m.has_position() ? "" : "no-position",              //
-        to_str<FormatTarget::HTML>(sig.forecast),           //
-        to_str<FormatTarget::HTML>(ticker.risk.sizing),     //
-        to_str<FormatTarget::HTML>(ticker.risk.stop_loss),  //
-        to_str<FormatTarget::HTML>(ticker.risk.target)      //
-    );
-
-    auto& risk = ticker.risk;
-
-    auto rationale = std::format(                                     //
-        rationale_template,                                            //
-        m.has_position() ? "" : "no-position",                        //
-        sig.rationale != "" ? sig.rationale : "--",                   //
-        risk.overall_rationale != "" ? risk.overall_rationale : "--"  //
-    );
-
-    body += std::format(                         //
-        index_signal_template,                   //
-        symbol,                                  //
-        overview,                                //
-        rationale,                               //
-        to_str<FormatTarget::HTML>(sig, ticker)  //
-    );
+    // a row is rendered again only when its ticker or event moved
+    auto stamp = mix(ticker.version, event_stamp(ticker.ev, today));
+    body += p.index_rows.get(symbol, stamp, [&] {
+      std::string row;
+
+      auto& m = ticker.metrics;
+      auto& ind_1h = m.ind_1h;
+
+      auto& sig = ticker.signal;
+      auto& sig_1h = ind_1h.signal;
+
+      auto stop_str = sig.stop_hit.str();
+      auto str = [&](auto src) {
+        return to_str<FormatTarget::HTML>(sig_1h, src);
+      };
+
+      row += std::format(                                                      //
+          index_row_template,                                                   //
+          symbol,                                                               //
+          to_str<FormatTarget::HTML>(sig.type),                                 //
+          hide(m, sig.type) ? "display:none;" : "",                             //
+          to_str<FormatTarget::HTML>(sig),                                      //
+          ticker.si.priority == 3 ? symbol : std::format("<b>{}</b>", symbol),  //
+          to_str<FormatTarget::HTML>(symbol, ticker.ev),                        //
+          str(Source::Price) + stop_str + str(Source::SR),                      //
+          str(Source::EMA),                                                     //
+          str(Source::RSI),                                                     //
+          str(Source::MACD),                                                    //
+          to_str<FormatTarget::HTML>(m.position, m.last_price()),               //
+          to_str<FormatTarget::HTML>(m, ticker.risk.stop_loss,                  //
+                                     ticker.risk.target)                        //
+      );
+
+      auto overview = std::format(                            //
+          signal_overview_template,                           //
+          m.has_position() ? "" : "no-position",              //
+          to_str<FormatTarget::HTML>(sig.forecast),           //
+          to_str<FormatTarget::HTML>(ticker.risk.sizing),     //
+          to_str<FormatTarget::HTML>(ticker.risk.stop_loss),  //
+          to_str<FormatTarget::HTML>(ticker.risk.target)      //
+      );
+
+      auto& risk = ticker.risk;
+
+      // rationales are kept as codes and only rendered here
+      auto sig_str = to_str<FormatTarget::HTML>(sig.rationale, sig);
+      auto risk_str = to_str<FormatTarget::HTML>(risk.overall_rationale, risk);
+
+      auto rationale = std::format(               //
+          rationale_template,                     //
+          m.has_position() ? "" : "no-position",  //
+          sig_str != "" ? sig_str : "--",         //
+          risk_str != "" ? risk_str : "--"        //
+      );
+
+      row += std::format(                         //
+          index_signal_template,                   //
+          symbol,                                  //
+          overview,                                //
+          rationale,                               //
+          to_str<FormatTarget::HTML>(sig, ticker)  //
+      );
+      return row;
+    });
   }
 
   auto last_updated = std::format("{:%a, %b %d, %H:%M}", p.last_updated);
   auto last_candle = std::format("{:%a, %b %d, %H:%M}", p.last_candle_time());
+  auto rules = rule_profiler.enabled() ? std::string{index_rules_link} : "";
   auto subtitle =
-      std::format(index_subtitle_template, last_updated, last_candle);
+      std::format(index_subtitle_template, last_updated, last_candle, rules);
 
   return std::format(index_template, subtitle, body);
 }
@@ -271,17 +297,19 @@ void Portfolio::write_index() const {
     if (fs::exists("page/public/index.html"))
       fs::copy_file(
           "page/public/index.html",
-          std::format("page/backup/index_{:%F_%T}.html", now_ny_time()),
+          std::format("page/backup/index_{:%F_%T}.html", wall_ny_time()),
           fs::copy_options::overwrite_existing);
   };
 
-  std::thread([=, this]() {
+  write_async([=, this] {
+    Span span{"page", "index"};
+    static auto& hist = telemetry.histogram(
+        "fin_page_write_ms", "Time to render and write a page",
+        {{"page", "index"}});
+    Timed t{hist};
     auto _ = reader_lock();
     auto fn = config.replay_en ? "page/public/index_replay.html"
                                : "page/public/index.html";
-    std::ofstream f{fn};
-    f << to_str<FormatTarget::HTML>(*this);
-    f.flush();
-    f.close();
-  }).detach();
+    write_if_changed(fn, to_str<FormatTarget::HTML>(*this));
+  });
 }
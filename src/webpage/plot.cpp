@@ -1,10 +1,16 @@
 #include "core/portfolio.h"
 #include "util/format.h"
+#include "util/telemetry.h"
+#include "util/trace.h"
 
 #include <spdlog/spdlog.h>
+#include <charconv>
+#include <filesystem>
 #include <fstream>
 #include <glaze/glaze.hpp>
 #include <iostream>
+#include <map>
+#include <mutex>
 
 inline constexpr std::string csv_fname(const std::string& symbol,
                                        const std::string& time,
@@ -52,25 +58,149 @@ inline void plot_sr(auto path, auto& support, auto& resistance) {
     spdlog::error("[plot] error writing sr json: {}", path.c_str());
 }
 
+// Rows go through to_chars into one buffer, the same text std::format
+// would give for "{:%F %T}" and "{:.2f}".
+class CsvBuffer {
+  std::string buf;
+
+  void put(const auto& v, auto... fmt) {
+    char tmp[64];
+    auto [end, ec] = std::to_chars(tmp, tmp + sizeof(tmp), v, fmt...);
+    if (ec == std::errc{})
+      buf.append(tmp, end);
+  }
+
+  void put2(unsigned v) {
+    buf += char('0' + v / 10);
+    buf += char('0' + v % 10);
+  }
+
+ public:
+  CsvBuffer& operator<<(std::string_view str) {
+    buf += str;
+    return *this;
+  }
+
+  CsvBuffer& operator<<(LocalTimePoint tp) {
+    using namespace std::chrono;
+    auto day = floor<days>(tp);
+    year_month_day ymd{day};
+    hh_mm_ss hms{tp - day};
+
+    put(int(ymd.year()));
+    buf += '-';
+    put2(unsigned(ymd.month()));
+    buf += '-';
+    put2(unsigned(ymd.day()));
+    buf += ' ';
+    put2(hms.hours().count());
+    buf += ':';
+    put2(hms.minutes().count());
+    buf += ':';
+    put2(hms.seconds().count());
+    return *this;
+  }
+
+  CsvBuffer& operator<<(double v) {
+    put(v, std::chars_format::fixed, 2);
+    return *this;
+  }
+
+  CsvBuffer& operator<<(int v) {
+    put(v);
+    return *this;
+  }
+
+  size_t size() const { return buf.size(); }
+  const std::string& str() const { return buf; }
+};
+
+// What the last plot left in a data csv: `rows` rows up to the candle at
+// `last`, whose row, possibly an open candle, starts at byte `tail`.
+struct PlotFile {
+  std::mutex mtx;
+  bool valid = false;
+  size_t rows = 0;
+  size_t size = 0;
+  size_t tail = 0;
+  LocalTimePoint last;
+};
+
+inline PlotFile& plot_file(const std::string& path) {
+  static std::mutex mtx;
+  static std::map<std::string, PlotFile, std::less<>> files;
+  std::lock_guard _{mtx};
+  return files[path];
+}
+
+inline void count_plot_bytes(bool rewrite, size_t n) {
+  static auto& appended = telemetry.counter(
+      "fin_plot_bytes_total", "Bytes of plot csv written",
+      {{"mode", "appended"}});
+  static auto& rewritten = telemetry.counter(
+      "fin_plot_bytes_total", "Bytes of plot csv written",
+      {{"mode", "rewritten"}});
+  (rewrite ? rewritten : appended).inc(n);
+}
+
 LocalTimePoint Indicators::plot(const std::string& sym,
                                 const std::string& time) const {
-  std::ofstream f(csv_fname(sym, time, "data"));
-  f << "datetime,open,close,high,low,volume,ema9,ema21,rsi,macd,signal\n";
-
   size_t n_candles_per_day = (D_1 + interval - minutes{1}) / interval;
   size_t n = std::min(candles.size(), n_candles_per_day * n_days_plot);
 
-  for (size_t i = candles.size() - n; i < candles.size(); i++)
-    f << std::format(
-        "{:%F %T},{:.2f},{:.2f},{:.2f},{:.2f},{},"
-        "{:.2f},{:.2f},{:.2f},{:.2f},{:.2f}\n",
-        candles[i].time(), candles[i].open, candles[i].close, candles[i].high,
-        candles[i].low, candles[i].volume, _ema9.values[i], _ema21.values[i],
-        _rsi.values[i], _macd.macd_line[i], _macd.signal_ema.values[i]);
+  auto path = csv_fname(sym, time, "data");
+  auto& file = plot_file(path);
+  std::lock_guard _{file.mtx};
 
-  f.flush();
+  auto row = [&](CsvBuffer& out, size_t i) {
+    out << candles[i].time() << "," << candles[i].open << ","
+        << candles[i].close << "," << candles[i].high << "," << candles[i].low
+        << "," << candles[i].volume << "," << _ema9.values[i] << ","
+        << _ema21.values[i] << "," << _rsi.values[i] << ","
+        << _macd.macd_line[i] << "," << _macd.signal_ema.values[i] << "\n";
+  };
+
+  // closed rows never change, so the file only needs its tail row redone
+  // and the new ones appended. a rewrite is due when the rows on disk are
+  // gone from the candles (an undo, a reload) or a day past the window
+  size_t from = candles.size() - n;
+  bool rewrite = !file.valid || file.rows > n + n_candles_per_day;
+  if (!rewrite) {
+    from = idx_for_time(file.last);
+    std::error_code ec;
+    rewrite = candles[from].time() != file.last ||
+              std::filesystem::file_size(path, ec) != file.size || ec;
+    if (!rewrite)
+      std::filesystem::resize_file(path, file.tail, ec);
+    rewrite = rewrite || ec;
+  }
+
+  CsvBuffer out;
+  if (rewrite) {
+    from = candles.size() - n;
+    file.rows = 0;
+    file.size = 0;
+    out << "datetime,open,close,high,low,volume,ema9,ema21,rsi,macd,signal\n";
+  } else {
+    file.rows--;
+    file.size = file.tail;
+  }
+
+  for (size_t i = from; i < candles.size(); i++) {
+    file.tail = file.size + out.size();
+    row(out, i);
+  }
+
+  std::ofstream f(path, rewrite ? std::ios::trunc : std::ios::app);
+  f << out.str();
   f.close();
 
+  file.valid = f.good();
+  file.rows += candles.size() - from;
+  file.size += out.size();
+  file.last = candles.back().time();
+  count_plot_bytes(rewrite, out.size());
+
   std::ofstream ff(csv_fname(sym, time, "trends"));
   ff << "plot,d0,v0,d1,v1\n";
 
@@ -129,6 +259,11 @@ void Portfolio::write_plot_data(const std::string& symbol) const {
     return;
 
   spdlog::trace("plotting {}", symbol.c_str());
+  Span _{"plot", symbol};
+  static auto& hist = telemetry.histogram(
+      "fin_page_write_ms", "Time to render and write a page",
+      {{"page", "plot"}});
+  Timed t{hist};
 
   auto start_time = it->second.metrics.plot(symbol);
 
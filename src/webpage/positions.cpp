@@ -1,9 +1,11 @@
 #include "core/portfolio.h"
 #include "util/format.h"
+#include "util/telemetry.h"
+#include "util/trace.h"
 
-#include <fstream>
+#include <bit>
+#include <functional>
 #include <string_view>
-#include <thread>
 
 inline constexpr std::string_view positions_template = R"(
 <!DOCTYPE html>
@@ -48,43 +50,67 @@ inline constexpr std::string_view positions_signal_template = R"(
 </table>
 )";
 
+// risk reads spy and the whole position book besides the ticker itself
+inline uint64_t positions_stamp(const Indicators& spy,
+                                const OpenPositions& positions) {
+  uint64_t h = spy.size();
+  if (spy.size() > 0)
+    h = mix(h, spy.time(-1).time_since_epoch().count());
+  for (auto& [symbol, pos] : positions.get_positions()) {
+    h = mix(h, std::hash<std::string>{}(symbol));
+    h = mix(h, std::bit_cast<uint64_t>(pos.qty));
+    h = mix(h, std::bit_cast<uint64_t>(pos.px));
+    h = mix(h, pos.tp.time_since_epoch().count());
+  }
+  return h;
+}
+
 template <>
-std::string to_str<FormatTarget::HTML>(const Tickers& tickers,
-                                       const Indicators& spy,
+std::string to_str<FormatTarget::HTML>(const Portfolio& p,
                                        const OpenPositions& positions) {
+  auto& spy = p.spy;
+  auto book = positions_stamp(spy, positions);
+
   std::string body = "";
   for (auto& [symbol, pos] : positions.get_positions()) {
-    auto it = tickers.find(symbol);
-    if (it == tickers.end())
+    auto it = p.tickers.find(symbol);
+    if (it == p.tickers.end())
       continue;
     auto& ticker = it->second;
 
-    body +=
-        std::format(positions_row_template, symbol, pos.tp, pos.qty, pos.px);
+    auto stamp = mix(book, ticker.version);
+    body += p.position_rows.get(symbol, stamp, [&] {
+      auto row =
+          std::format(positions_row_template, symbol, pos.tp, pos.qty, pos.px);
 
-    auto& m = ticker.metrics;
-    CombinedSignal combined_signal{m, ticker.ev, pos.tp};
-    auto sig_1h = m.ind_1h.get_signal(pos.tp);
-    auto sig_4h = m.ind_4h.get_signal(pos.tp);
-    auto sig_1d = m.ind_1d.get_signal(pos.tp);
-    Risk risk{m, spy, pos.tp, combined_signal, positions, ticker.ev};
+      auto& m = ticker.metrics;
+      CombinedSignal combined_signal{m, ticker.ev, pos.tp};
+      auto sig_1h = m.ind_1h.get_signal(pos.tp);
+      auto sig_4h = m.ind_4h.get_signal(pos.tp);
+      auto sig_1d = m.ind_1d.get_signal(pos.tp);
+      Risk risk{m, spy, pos.tp, combined_signal, positions, ticker.ev};
 
-    body += std::format(                                     //
-        positions_signal_template,                           //
-        risk.overall_rationale,                              //
-        to_str<FormatTarget::HTML>(combined_signal, ticker)  //
-    );
+      row += std::format(                                            //
+          positions_signal_template,                                 //
+          to_str<FormatTarget::HTML>(risk.overall_rationale, risk),  //
+          to_str<FormatTarget::HTML>(combined_signal, ticker)        //
+      );
+      return row;
+    });
   }
 
   return std::format(positions_template, body);
 }
 
 void Portfolio::write_positions() const {
-  std::thread([this]() {
+  write_async([this] {
+    Span span{"page", "positions"};
+    static auto& hist = telemetry.histogram(
+        "fin_page_write_ms", "Time to render and write a page",
+        {{"page", "positions"}});
+    Timed t{hist};
     auto _ = reader_lock();
-    std::ofstream f("page/public/positions.html");
-    f << to_str<FormatTarget::HTML>(tickers, spy, positions);
-    f.flush();
-    f.flush();
-  }).detach();
+    write_if_changed("page/public/positions.html",
+                     to_str<FormatTarget::HTML>(*this, positions));
+  });
 }
@@ -0,0 +1,82 @@
+#include "core/portfolio.h"
+#include "sig/rule_profile.h"
+#include "util/telemetry.h"
+#include "util/trace.h"
+
+#include <fstream>
+#include <string_view>
+
+inline constexpr std::string_view rules_template = R"(
+<!DOCTYPE html>
+<html>
+  <head>
+    <meta charset="utf-8">
+    <title>Rules</title>
+    <link rel="stylesheet" href="css/ticker.css">
+  </head>
+  <body>
+    <table>
+      <tr class="header">
+        <th>Kind</th>
+        <th>Rule</th>
+        <th>Path</th>
+        <th>TF</th>
+        <th>Calls</th>
+        <th>Fire rate</th>
+        <th>Total ms</th>
+        <th>Avg ns</th>
+        <th>p99 ns</th>
+        <th>Allocs/call</th>
+      </tr>
+      {}
+    </table>
+  </body>
+</html>
+)";
+
+inline constexpr std::string_view rules_row_template = R"(
+  <tr>
+    <td>{}</td>
+    <td>{}</td>
+    <td>{}</td>
+    <td>{}</td>
+    <td>{}</td>
+    <td>{:.2f}%</td>
+    <td>{:.1f}</td>
+    <td>{:.0f}</td>
+    <td>{:.0f}</td>
+    <td>{:.1f}</td>
+  </tr>
+)";
+
+inline std::string tf_str(minutes tf) {
+  if (tf == minutes{0})
+    return "all";
+  if (tf == D_1)
+    return "1d";
+  return std::format("{}h", tf.count() / 60);
+}
+
+void Portfolio::write_rules() const {
+  if (!rule_profiler.enabled())
+    return;
+
+  write_async([] {
+    Span span{"page", "rules"};
+    static auto& hist = telemetry.histogram(
+        "fin_page_write_ms", "Time to render and write a page",
+        {{"page", "rules"}});
+    Timed t{hist};
+
+    std::string body;
+    for (auto& r : rule_profiler.rows())
+      body += std::format(rules_row_template, r.kind, r.name,
+                          r.path == RulePath::Live ? "live" : "backtest",
+                          tf_str(r.timeframe), r.calls, 100 * r.fire_rate,
+                          r.total_ms, r.avg_ns, r.p99_ns, r.allocs_per_call);
+
+    std::ofstream f("page/public/rules.html");
+    f << std::format(rules_template, body);
+    f.flush();
+  });
+}
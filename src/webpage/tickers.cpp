@@ -1,8 +1,7 @@
 #include "core/portfolio.h"
 #include "util/format.h"
-
-#include <fstream>
-#include <thread>
+#include "util/telemetry.h"
+#include "util/trace.h"
 
 inline constexpr std::string_view ticker_template = R"(
 <!DOCTYPE html>
@@ -183,26 +182,38 @@ inline std::string to_str<FormatTarget::HTML>(const Ticker& ticker) {
   );
 }
 
+void Portfolio::write_ticker(const Ticker& ticker) const {
+  auto& symbol = ticker.si.symbol;
+  if (!ticker_pages.stale(symbol, ticker.version))
+    return;
+
+  Span _{"page", symbol};
+  static auto& hist = telemetry.histogram(
+      "fin_page_write_ms", "Time to render and write a page",
+      {{"page", "ticker"}});
+  Timed t{hist};
+
+  bool ok = write_if_changed(std::format("page/public/{}.html", symbol),
+                             to_str<FormatTarget::HTML>(ticker));
+
+  auto print_ind = [&](auto& ind, auto& time) {
+    ok &= write_if_changed(std::format("page/public/{}_{}.html", symbol, time),
+                           to_str<FormatTarget::HTML>(ind));
+  };
+
+  print_ind(ticker.metrics.ind_1h, "1h");
+  print_ind(ticker.metrics.ind_4h, "4h");
+  print_ind(ticker.metrics.ind_1d, "1d");
+
+  // a failed file is rendered again next time
+  if (ok)
+    ticker_pages.store(symbol, ticker.version);
+}
+
 void Portfolio::write_tickers() const {
-  std::thread([this]() {
+  write_async([this] {
     auto _ = reader_lock();
-
-    for (auto& [symbol, ticker] : tickers) {
-      std::ofstream f(std::format("page/public/{}.html", symbol));
-      f << to_str<FormatTarget::HTML>(ticker);
-      f.flush();
-      f.flush();
-
-      auto print_ind = [&](auto& ind, auto& time) {
-        std::ofstream f(std::format("page/public/{}_{}.html", symbol, time));
-        f << to_str<FormatTarget::HTML>(ind);
-        f.flush();
-        f.flush();
-      };
-
-      print_ind(ticker.metrics.ind_1h, "1h");
-      print_ind(ticker.metrics.ind_4h, "4h");
-      print_ind(ticker.metrics.ind_1d, "1d");
-    }
-  }).detach();
+    for (auto& [symbol, ticker] : tickers)
+      write_ticker(ticker);
+  });
 }